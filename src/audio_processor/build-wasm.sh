@@ -0,0 +1,56 @@
+#!/usr/bin/env bash
+# 重新构建 wasm 包并校验新导出是否就位。
+#
+# pkg/ 下的产物是入库的（浏览器直接加载），改动 src/lib.rs 后必须
+# 重新运行本脚本（或等效的 wasm-pack 命令）再提交——否则
+# True Peak / 暂存缓冲区 / MusicAnalyzer 等特性会因为旧构建缺少
+# 导出而一直走回退路径，等于没发布。
+#
+# 用法:
+#   ./build-wasm.sh                   重新构建并校验产物
+#   ./build-wasm.sh --verify-committed  只校验已提交的 pkg/ 是否包含
+#                                       全部必需导出（CI 合并门禁用）
+#
+# 依赖: wasm-pack (cargo install wasm-pack) 与 wasm32 目标
+#       (rustup target add wasm32-unknown-unknown)
+set -euo pipefail
+cd "$(dirname "$0")"
+
+# 本仓库 JS 侧依赖的导出，缺一个都视为失败
+REQUIRED_EXPORTS=(
+    staging_ptr_l
+    staging_ptr_r
+    staging_capacity
+    process_staged
+    true_peak_l_db
+    MusicAnalyzer
+    results_ptr
+)
+
+verify_exports() {
+    local target="$1"
+    local missing=0
+    for symbol in "${REQUIRED_EXPORTS[@]}"; do
+        if ! grep -q "$symbol" "$target"; then
+            echo "错误: $target 缺少导出 '$symbol'" >&2
+            missing=1
+        fi
+    done
+    return $missing
+}
+
+# --verify-committed: 只校验已提交的 pkg/ 是否包含全部必需导出
+# （CI 用它把“改了 lib.rs 但没重建 pkg/”挡在合并之前）
+if [[ "${1:-}" == "--verify-committed" ]]; then
+    if verify_exports pkg/audio_processor.js; then
+        echo "已提交的 pkg/ 包含全部 ${#REQUIRED_EXPORTS[@]} 个必需导出。"
+        exit 0
+    fi
+    echo "已提交的 pkg/ 是过期构建：请运行 ./build-wasm.sh 并提交 pkg/。" >&2
+    exit 1
+fi
+
+wasm-pack build --target web --out-dir pkg
+
+verify_exports pkg/audio_processor.js || exit 1
+echo "wasm 构建完成，全部 ${#REQUIRED_EXPORTS[@]} 个必需导出均已就位。"
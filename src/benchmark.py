@@ -0,0 +1,273 @@
+# -*- coding: utf-8 -*-
+"""
+功能:
+    webplayer 热路径基准测试套件。生成合成媒体树、按脚本化场景压测
+    运行中的 server.js，并以机器可读的 JSON 输出每个场景的
+    p50/p95 延迟与吞吐量，便于跨版本 diff 找回归。
+
+    只依赖标准库（urllib / concurrent.futures），可在任何能跑
+    server.js 的机器上直接运行。
+
+场景:
+    - list_cold / list_warm        冷/热目录浏览（传统 JSON 列表）
+    - list_ndjson                  流式 NDJSON 列表（首屏路径）
+    - playlist_batch               一次请求解析整个播放列表元数据（缓存命中路径）
+    - thumbnail_storm              并发缩略图风暴（命中磁盘缓存或生成队列）
+    - sort_by_time_cold / _warm    时间排序（工作窃取扫描 vs foldercache 命中）
+    - semantic_search              语义搜索（Flask 后端在线时测冷/热，离线则跳过）
+    - static_range                 媒体文件 Range 读取（流式播放路径）
+
+用法:
+    1. 生成合成媒体树（在 config.json 的媒体目录里，或任意目录）:
+       python benchmark.py --generate /tmp/bench-tree --dirs 50 --files-per-dir 40
+
+    2. 启动 server.js（媒体目录指向合成树），然后执行:
+       python benchmark.py --base-url http://localhost:8080 --media-dir /tmp/bench-tree
+
+    3. 输出为单个 JSON 文档（stdout，或 --output results.json），
+       跨版本对比: 跑两次各存一份，diff p50/p95 即可。
+"""
+import argparse
+import concurrent.futures
+import json
+import os
+import random
+import statistics
+import sys
+import time
+import urllib.parse
+import urllib.request
+import urllib.error
+
+
+# ============================================================
+# 合成媒体树生成
+# ============================================================
+
+def generate_tree(root, dirs, files_per_dir, file_size):
+    """生成可配置规模的合成媒体树（伪视频/音频文件 + 嵌套目录）。"""
+    random.seed(42)  # 可复现
+    extensions = ['.mp4', '.mkv', '.mp3', '.flac', '.jpg']
+    os.makedirs(root, exist_ok=True)
+    payload = os.urandom(min(file_size, 4096))
+    for d in range(dirs):
+        dir_path = os.path.join(root, f"folder_{d:04d}")
+        os.makedirs(dir_path, exist_ok=True)
+        for f in range(files_per_dir):
+            ext = extensions[f % len(extensions)]
+            file_path = os.path.join(dir_path, f"media_{d:04d}_{f:04d}{ext}")
+            with open(file_path, 'wb') as fh:
+                # 内容用小块填充到目标大小（避免真写出 GB 级数据）
+                remaining = file_size
+                while remaining > 0:
+                    chunk = payload[:min(len(payload), remaining)]
+                    fh.write(chunk)
+                    remaining -= len(chunk)
+    total_files = dirs * files_per_dir
+    print(f"合成媒体树已生成: {root} ({dirs} 目录 / {total_files} 文件 / 每文件 {file_size}B)", file=sys.stderr)
+
+
+# ============================================================
+# 压测原语
+# ============================================================
+
+def timed_request(url, method='GET', body=None, timeout=60, headers=None):
+    """执行一次请求，返回 (耗时毫秒, 状态码或异常名, 响应字节数)。"""
+    start = time.perf_counter()
+    try:
+        request = urllib.request.Request(url, method=method)
+        for key, value in (headers or {}).items():
+            request.add_header(key, value)
+        data = None
+        if body is not None:
+            data = json.dumps(body).encode('utf-8')
+            request.add_header('Content-Type', 'application/json')
+        with urllib.request.urlopen(request, data=data, timeout=timeout) as resp:
+            size = len(resp.read())
+            return (time.perf_counter() - start) * 1000, resp.status, size
+    except urllib.error.HTTPError as e:
+        return (time.perf_counter() - start) * 1000, e.code, 0
+    except Exception as e:
+        return (time.perf_counter() - start) * 1000, type(e).__name__, 0
+
+
+def run_scenario(name, request_specs, concurrency=1):
+    """执行一个场景：request_specs 为 (url, method, body) 列表。
+
+    返回 {count, errors, p50_ms, p95_ms, max_ms, throughput_rps, bytes_total}。
+    """
+    latencies = []
+    errors = 0
+    bytes_total = 0
+    wall_start = time.perf_counter()
+
+    def one(spec):
+        url, method, body = spec[:3]
+        headers = spec[3] if len(spec) > 3 else None
+        return timed_request(url, method=method, body=body, headers=headers)
+
+    if concurrency > 1:
+        with concurrent.futures.ThreadPoolExecutor(max_workers=concurrency) as executor:
+            results = list(executor.map(one, request_specs))
+    else:
+        results = [one(s) for s in request_specs]
+
+    wall = time.perf_counter() - wall_start
+    for ms, status, size in results:
+        latencies.append(ms)
+        bytes_total += size
+        if not isinstance(status, int) or status >= 400:
+            errors += 1
+
+    latencies.sort()
+    def pct(p):
+        if not latencies:
+            return 0.0
+        idx = min(len(latencies) - 1, int(round(p / 100 * (len(latencies) - 1))))
+        return round(latencies[idx], 2)
+
+    stats = {
+        'count': len(latencies),
+        'errors': errors,
+        'p50_ms': pct(50),
+        'p95_ms': pct(95),
+        'max_ms': round(max(latencies), 2) if latencies else 0.0,
+        'mean_ms': round(statistics.mean(latencies), 2) if latencies else 0.0,
+        'throughput_rps': round(len(latencies) / wall, 1) if wall > 0 else 0.0,
+        'bytes_total': bytes_total,
+        'concurrency': concurrency
+    }
+    print(f"[{name}] n={stats['count']} err={errors} p50={stats['p50_ms']}ms p95={stats['p95_ms']}ms rps={stats['throughput_rps']}", file=sys.stderr)
+    return stats
+
+
+# ============================================================
+# 场景定义
+# ============================================================
+
+def build_scenarios(base, media_dir, folder_names, file_names, iterations):
+    """返回 {场景名: callable}。callable 执行场景并返回统计。"""
+    enc = urllib.parse.quote
+    scenarios = {}
+
+    sample_folders = folder_names[:iterations] or ['']
+    list_specs = [(f"{base}/list/{enc(name)}", 'GET', None) for name in sample_folders]
+    # 冷浏览：每个目录第一次 /list（进程级 listing 缓存未命中）
+    scenarios['list_cold'] = lambda: run_scenario('list_cold', list_specs)
+    # 热浏览：同一批目录再来一轮（应命中 listing 内存缓存）
+    scenarios['list_warm'] = lambda: run_scenario('list_warm', list_specs)
+    # 流式 NDJSON 列表
+    ndjson_specs = [(f"{base}/list/{enc(name)}?format=ndjson", 'GET', None) for name in sample_folders]
+    scenarios['list_ndjson'] = lambda: run_scenario('list_ndjson', ndjson_specs)
+
+    # 播放列表批量元数据（全部缓存未命中时只测 DB 路径：resolveMisses=false）
+    audio_files = [f for f in file_names if f.endswith(('.mp3', '.flac'))][:500]
+    if audio_files:
+        batch_body = {'paths': audio_files, 'mediaDir': media_dir, 'resolveMisses': False}
+        scenarios['playlist_batch'] = lambda: run_scenario(
+            'playlist_batch', [(f"{base}/api/music-info/batch", 'POST', batch_body)] * 3)
+
+    # 并发缩略图风暴（图片直接流式返回；视频走生成队列）
+    image_files = [f for f in file_names if f.endswith('.jpg')][:iterations * 4]
+    if image_files:
+        storm_specs = [(f"{base}/thumbnail/{enc(f)}?mediaDir={enc(media_dir)}", 'GET', None) for f in image_files]
+        scenarios['thumbnail_storm'] = lambda: run_scenario('thumbnail_storm', storm_specs, concurrency=16)
+
+    # 时间排序：冷（全树扫描）与热（foldercache 命中）
+    scenarios['sort_by_time_cold'] = lambda: run_scenario(
+        'sort_by_time_cold', [(f"{base}/api/sort-by-time?path=/&order=desc", 'GET', None)])
+    scenarios['sort_by_time_warm'] = lambda: run_scenario(
+        'sort_by_time_warm', [(f"{base}/api/sort-by-time?path=/&order=desc", 'GET', None)] * 3)
+
+    # 媒体 Range 读取（顺序流式播放路径）
+    video_files = [f for f in file_names if f.endswith('.mp4')][:iterations]
+    if video_files:
+        # 带 Range 头，真实走 206 流式路径
+        range_specs = [(f"{base}/{enc(f)}?mediaDir={enc(media_dir)}", 'GET', None,
+                        {'Range': 'bytes=0-262143'}) for f in video_files]
+        scenarios['static_range'] = lambda: run_scenario('static_range', range_specs, concurrency=4)
+
+    # 语义搜索（后端在线时才有意义；离线会记为错误，照常输出）
+    scenarios['semantic_search'] = lambda: run_scenario(
+        'semantic_search',
+        [(f"{base}/api/semantic-search?scope=library&query={enc('测试查询')}", 'GET', None)] * 2)
+
+    return scenarios
+
+
+def discover_tree(base, media_dir):
+    """通过 /list 发现合成树的目录与文件（相对路径）。"""
+    folders, files = [], []
+    try:
+        with urllib.request.urlopen(f"{base}/list", timeout=30) as resp:
+            entries = json.loads(resp.read())
+    except Exception as e:
+        print(f"错误: 无法访问 {base}/list: {e}", file=sys.stderr)
+        return folders, files
+    for entry in entries:
+        if entry.get('isDirectory'):
+            folders.append(entry['name'])
+        else:
+            files.append(entry['name'])
+    # 进入每个目录收集文件（上限避免超大树拖慢发现阶段）
+    for folder in folders[:100]:
+        try:
+            with urllib.request.urlopen(f"{base}/list/{urllib.parse.quote(folder)}", timeout=30) as resp:
+                for entry in json.loads(resp.read()):
+                    if not entry.get('isDirectory'):
+                        files.append(f"{folder}/{entry['name']}")
+        except Exception:
+            continue
+    return folders, files
+
+
+def main():
+    parser = argparse.ArgumentParser(description='webplayer 热路径基准测试')
+    parser.add_argument('--generate', metavar='ROOT', help='生成合成媒体树到指定目录后退出')
+    parser.add_argument('--dirs', type=int, default=50, help='合成树的目录数')
+    parser.add_argument('--files-per-dir', type=int, default=40, help='每目录文件数')
+    parser.add_argument('--file-size', type=int, default=64 * 1024, help='每文件字节数')
+    parser.add_argument('--base-url', default='http://localhost:8080', help='server.js 地址')
+    parser.add_argument('--media-dir', default='', help='服务端配置的媒体目录（缩略图/批量接口需要）')
+    parser.add_argument('--iterations', type=int, default=20, help='每场景采样目录/文件数')
+    parser.add_argument('--scenarios', help='只跑指定场景（逗号分隔）')
+    parser.add_argument('--output', help='结果 JSON 输出文件（默认 stdout）')
+    args = parser.parse_args()
+
+    if args.generate:
+        generate_tree(args.generate, args.dirs, args.files_per_dir, args.file_size)
+        return
+
+    base = args.base_url.rstrip('/')
+    print(f"发现媒体树结构: {base}/list ...", file=sys.stderr)
+    folders, files = discover_tree(base, args.media_dir)
+    print(f"发现 {len(folders)} 目录 / {len(files)} 文件", file=sys.stderr)
+
+    scenarios = build_scenarios(base, args.media_dir, folders, files, args.iterations)
+    if args.scenarios:
+        wanted = {s.strip() for s in args.scenarios.split(',')}
+        scenarios = {k: v for k, v in scenarios.items() if k in wanted}
+
+    results = {
+        'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S'),
+        'base_url': base,
+        'tree': {'folders': len(folders), 'files': len(files)},
+        'scenarios': {}
+    }
+    for name, run in scenarios.items():
+        try:
+            results['scenarios'][name] = run()
+        except Exception as e:
+            results['scenarios'][name] = {'error': str(e)}
+
+    output = json.dumps(results, ensure_ascii=False, indent=2)
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8') as f:
+            f.write(output)
+        print(f"结果已写入: {args.output}", file=sys.stderr)
+    else:
+        print(output)
+
+
+if __name__ == '__main__':
+    main()
@@ -366,6 +366,86 @@ class SmartFolderModTimeManager:
         self._save_to_cache(info)
         return info
     
+    def compute_real_mtimes_workstealing(self, folder_paths: List[str], on_root_complete=None) -> Dict[str, Optional[datetime]]:
+        """批量计算多个根文件夹的真实最新修改时间（工作窃取调度）。
+
+        与按文件夹静态划分任务的线程池不同，这里所有 worker 共享一个目录
+        任务队列：worker 扫描一层目录，文件的 mtime 并入所属根文件夹的最大值，
+        子目录作为新任务放回队列，供任何空闲 worker 取走。深而大的子树因此
+        被动态拆分，静态划分下"一个线程困在 90k 文件的子树里"的长尾消失。
+
+        on_root_complete(root, mtime) 会在某个根文件夹的全部子树扫描完成时
+        立即回调（mtime 为 None 表示没有扫到任何文件），供流式模式逐步修正排序。
+        """
+        import queue as queue_module
+
+        tasks = queue_module.SimpleQueue()
+        state_lock = threading.Lock()
+        max_mtime = {p: 0.0 for p in folder_paths}
+        outstanding = {p: 0 for p in folder_paths}
+        total_outstanding = [0]
+        results: Dict[str, Optional[datetime]] = {}
+
+        def add_task(root, directory):
+            with state_lock:
+                outstanding[root] += 1
+                total_outstanding[0] += 1
+            tasks.put((root, directory))
+
+        def finish_task(root):
+            completed = False
+            with state_lock:
+                outstanding[root] -= 1
+                total_outstanding[0] -= 1
+                if outstanding[root] == 0:
+                    completed = True
+                    mt = max_mtime[root]
+            if completed:
+                real_mtime = datetime.fromtimestamp(mt) if mt > 0 else None
+                results[root] = real_mtime
+                if on_root_complete:
+                    try:
+                        on_root_complete(root, real_mtime)
+                    except Exception as e:
+                        logger.warning(f"on_root_complete 回调出错 {root}: {e}")
+
+        for p in folder_paths:
+            add_task(p, p)
+
+        def worker():
+            while True:
+                try:
+                    root, directory = tasks.get(timeout=0.05)
+                except queue_module.Empty:
+                    with state_lock:
+                        if total_outstanding[0] == 0:
+                            return
+                    continue
+                try:
+                    with os.scandir(directory) as entries:
+                        for entry in entries:
+                            try:
+                                if entry.is_dir(follow_symlinks=False):
+                                    add_task(root, entry.path)
+                                elif entry.is_file(follow_symlinks=False):
+                                    mtime = entry.stat(follow_symlinks=False).st_mtime
+                                    with state_lock:
+                                        if mtime > max_mtime[root]:
+                                            max_mtime[root] = mtime
+                            except OSError:
+                                continue
+                except OSError:
+                    pass
+                finally:
+                    finish_task(root)
+
+        threads = [threading.Thread(target=worker, daemon=True) for _ in range(self.max_workers)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        return results
+
     def get_folders_real_mtime_batch(self, folder_paths: List[str]) -> Dict[str, FolderInfo]:
         """批量获取多个文件夹的真实修改时间"""
         results = {}
@@ -427,7 +507,88 @@ class SmartFolderModTimeManager:
 
 # --- 使用示例 ---
 if __name__ == "__main__":
-    
+
+    def process_items_streaming(target_path: str, reverse_sort=True):
+        """流式模式：以 NDJSON 输出排序结果，冷缓存下第一屏也能立即可用。
+
+        1. provisional —— 立即输出临时排序：文件夹用缓存命中的真实 mtime，
+           未缓存的先用文件夹自身 mtime 占位；
+        2. reorder    —— 工作窃取调度计算未缓存文件夹的真实 mtime，
+           每完成一批（节流 0.5s）输出一次修正后的完整排序；
+        3. done       —— 全部根文件夹完成后输出最终排序。
+        """
+        def emit(obj):
+            print(json.dumps(obj, ensure_ascii=False), flush=True)
+
+        if not os.path.isdir(target_path):
+            emit({"type": "error", "message": f"路径 '{target_path}' 不是一个有效的目录。"})
+            return
+
+        manager = SmartFolderModTimeManager(use_database_cache=True)
+
+        items: Dict[str, dict] = {}  # path -> {'mtime': float, 'is_dir': bool, 'method': str}
+        uncached_roots = []
+        try:
+            with os.scandir(target_path) as entries:
+                for entry in entries:
+                    try:
+                        stat = entry.stat()
+                    except OSError:
+                        continue
+                    if entry.is_dir():
+                        cached = manager._get_from_cache(os.path.abspath(entry.path))
+                        if cached:
+                            items[entry.path] = {'mtime': cached.real_mtime.timestamp(), 'is_dir': True, 'method': '缓存命中'}
+                        else:
+                            # 占位：文件夹自身的 mtime，真实值由后台扫描修正
+                            items[entry.path] = {'mtime': stat.st_mtime, 'is_dir': True, 'method': 'provisional'}
+                            uncached_roots.append(entry.path)
+                    else:
+                        items[entry.path] = {'mtime': stat.st_mtime, 'is_dir': False, 'method': 'scandir'}
+        except OSError as e:
+            emit({"type": "error", "message": f"无法访问路径 '{target_path}'。 {e}"})
+            return
+
+        items_lock = threading.Lock()
+
+        def sorted_payload():
+            with items_lock:
+                ordered = sorted(items.items(), key=lambda kv: kv[1]['mtime'], reverse=reverse_sort)
+                return [{
+                    "path": p,
+                    "mtime": datetime.fromtimestamp(v['mtime']).isoformat(),
+                    "item_type": "folder" if v['is_dir'] else "file",
+                    "method": v['method']
+                } for p, v in ordered]
+
+        emit({"type": "provisional", "pending": len(uncached_roots), "items": sorted_payload()})
+
+        if uncached_roots:
+            emit_lock = threading.Lock()
+            last_emit = [time.time()]
+
+            def on_root_complete(root, real_mtime):
+                with items_lock:
+                    if real_mtime is not None:
+                        items[root]['mtime'] = real_mtime.timestamp()
+                    items[root]['method'] = 'workstealing'
+                # 结果写回缓存，下次直接命中
+                manager._save_to_cache(FolderInfo(
+                    path=os.path.abspath(root),
+                    real_mtime=real_mtime if real_mtime is not None else datetime.fromtimestamp(items[root]['mtime']),
+                    cache_time=datetime.now(),
+                    method_used='workstealing'
+                ))
+                with emit_lock:
+                    now = time.time()
+                    if now - last_emit[0] >= 0.5:
+                        last_emit[0] = now
+                        emit({"type": "reorder", "items": sorted_payload()})
+
+            manager.compute_real_mtimes_workstealing(uncached_roots, on_root_complete)
+
+        emit({"type": "done", "items": sorted_payload()})
+
     def process_items_optimized(target_path: str, reverse_sort=True, output_json=False, fast_mode=False):
         """
         【已优化】处理指定路径下的一级项目（文件和文件夹），使用批量并行处理。
@@ -561,13 +722,18 @@ if __name__ == "__main__":
                         help="如果指定，则以JSON格式输出结果。")
     parser.add_argument("-f", dest="fast_mode", action="store_true",
                         help="快速模式：仅扫描文件夹第一层，速度更快但可能不够精确。")
-    
+    parser.add_argument("-stream", dest="stream_output", action="store_true",
+                        help="流式模式：以 NDJSON 输出，先给出缓存/占位的临时排序，真实 mtime 到齐后逐步修正。")
+
     args = parser.parse_args()
-    
+
     reverse_order = args.sort_order == "desc"
-    
+
     if os.path.exists(args.target_path):
-        process_items_optimized(args.target_path, reverse_sort=reverse_order, output_json=args.json_output, fast_mode=args.fast_mode)
+        if args.stream_output:
+            process_items_streaming(args.target_path, reverse_sort=reverse_order)
+        else:
+            process_items_optimized(args.target_path, reverse_sort=reverse_order, output_json=args.json_output, fast_mode=args.fast_mode)
     else:
         error_message = f"\n错误：路径 '{args.target_path}' 不存在。"
         if args.json_output:
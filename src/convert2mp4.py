@@ -279,13 +279,23 @@ def verify_video_file(file_path):
     except Exception as e:
         return False, f"验证异常: {str(e)}"
 
-def convert_video_to_mp4(input_path):
+def convert_video_to_mp4(input_path, encoder=None, label=None, finalize_executor=None):
     """
     智能转码视频文件为 MP4 格式
+
+    Args:
+        encoder: 预先检测好的编码器（批量模式下只检测一次）；None 时自动检测。
+        label: 批量模式下的进度前缀（多文件进度复用同一 stdout）。
+        finalize_executor: 提供时，校验+替换提交到该执行器异步进行
+                           （与下一个文件的编码重叠）。
+
+    Returns:
+        'ok' | 'encode_failed' | 'error'，或 finalize_executor 模式下的
+        ('pending', future)，future 结果为 'ok' / 'error'。
     """
     if not os.path.exists(input_path):
         print(f"错误：文件不存在 -> {input_path}")
-        sys.exit(1)
+        return 'error'
 
     # 获取原始文件状态
     try:
@@ -296,15 +306,15 @@ def convert_video_to_mp4(input_path):
 
     print(f"处理文件：{input_path}")
 
-    # 1. 自动检测最佳编码器
-    best_encoder = get_optimal_encoder()
+    # 1. 自动检测最佳编码器（批量模式下由调用方传入，避免重复检测）
+    best_encoder = encoder if encoder else get_optimal_encoder()
     print(f"选用编码器: {best_encoder}")
 
     # 2. 获取源视频信息
     source_info = get_video_info(input_path)
     if not source_info:
         print("无法获取源视频信息，无法继续。")
-        sys.exit(1)
+        return 'error'
 
     bit_rate = source_info.get('bit_rate')
     if not bit_rate:
@@ -372,6 +382,7 @@ def convert_video_to_mp4(input_path):
                                    encoding='utf-8',
                                    errors='ignore')
 
+        last_progress_emit = [0.0]
         time_pattern = re.compile(r'time=(\d{2}:\d{2}:\d{2}.\d{2})')
         speed_pattern = re.compile(r'speed=\s*(\d+\.?\d*x)')
         
@@ -394,73 +405,202 @@ def convert_video_to_mp4(input_path):
                 if source_info['duration'] and source_info['duration'] > 0:
                     progress_percent = (current_time_sec / source_info['duration']) * 100
                 
-                sys.stdout.write(f"\r进度: {progress_percent:.2f}% | 当前时间: {current_time_str} | 速度: {speed}")
-                sys.stdout.flush()
+                if label:
+                    # 批量模式：带文件前缀按行节流输出（\r 多文件下会互相覆盖）
+                    now = time.time()
+                    if now - last_progress_emit[0] >= 2.0:
+                        last_progress_emit[0] = now
+                        print(f"[{label}] 进度: {progress_percent:.2f}% | 速度: {speed}", flush=True)
+                else:
+                    sys.stdout.write(f"\r进度: {progress_percent:.2f}% | 当前时间: {current_time_str} | 速度: {speed}")
+                    sys.stdout.flush()
         
         sys.stdout.write("\n")
         process.wait()
 
         if process.returncode == 0:
+            if finalize_executor is not None:
+                # 校验+替换与下一个文件的编码重叠执行
+                future = finalize_executor.submit(
+                    _finalize_conversion, input_path, output_path, dir_name,
+                    file_name, file_extension, orig_stat, label
+                )
+                return ('pending', future)
             print("\n转码完成，正在进行文件校验...")
-            is_valid, validation_msg = verify_video_file(output_path)
-            
-            if is_valid:
-                print(f"校验通过：{validation_msg}")
-                final_path = os.path.join(dir_name, file_name + '.mp4')
-                
-                # 安全替换逻辑 (快速覆盖模式)
-                try:
-                    if file_extension.lower() == '.mp4':
-                        # 原文件就是MP4
-                        print("原文件已是 MP4 格式，将进行覆盖替换。")
-                        os.replace(output_path, final_path) # 原子替换
-                        print(f"替换完成 -> {final_path}")
-                    else:
-                        # 原文件不是MP4
-                        if os.path.exists(final_path):
-                            print(f"目标文件已存在，将被覆盖: {final_path}")
-                        
-                        # 先尝试删除原文件（如同快速模式逻辑）
-                        try:
-                            if os.path.exists(input_path):
-                                os.remove(input_path)
-                        except OSError as e:
-                            print(f"删除原文件失败: {e}")
-
-                        os.replace(output_path, final_path)
-                        print(f"新文件已就绪 -> {final_path}")
-
-                    # 尝试恢复文件时间戳
-                    if orig_stat:
-                        try:
-                            set_creation_time(final_path, orig_stat.st_ctime)
-                        except Exception:
-                            pass
-                        try:
-                            os.utime(final_path, (orig_stat.st_atime, orig_stat.st_mtime))
-                        except Exception:
-                            pass
-                        print("已恢复原始文件时间戳。")
-                        
-                except OSError as e:
-                    print(f"替换文件时发生错误: {e}")
-                    # 如果替换失败，保留临时文件
-            else:
-                print(f"校验失败：{validation_msg}")
-                print(f"保留临时文件以供检查：{output_path}")
+            return _finalize_conversion(input_path, output_path, dir_name,
+                                        file_name, file_extension, orig_stat, label)
         else:
             print(f"\n转码失败，FFmpeg 退出码：{process.returncode}")
             if os.path.exists(output_path):
                 os.remove(output_path)
+            return 'encode_failed'
 
     except FileNotFoundError:
         print("错误：未找到 ffmpeg 或 ffprobe 可执行文件。请确保它们已正确安装并添加到 PATH 环境变量中。")
+        return 'error'
     except Exception as e:
         print(f"发生错误：{e}")
+        return 'error'
+
+
+def _finalize_conversion(input_path, output_path, dir_name, file_name, file_extension, orig_stat, label=None):
+    """转码后的校验与安全替换（批量模式下在独立线程执行，与下个编码重叠）。"""
+    prefix = f"[{label}] " if label else ""
+    try:
+        is_valid, validation_msg = verify_video_file(output_path)
+
+        if is_valid:
+            print(f"{prefix}校验通过：{validation_msg}")
+            final_path = os.path.join(dir_name, file_name + '.mp4')
+
+            # 安全替换逻辑 (快速覆盖模式)
+            try:
+                if file_extension.lower() == '.mp4':
+                    # 原文件就是MP4
+                    print(f"{prefix}原文件已是 MP4 格式，将进行覆盖替换。")
+                    os.replace(output_path, final_path) # 原子替换
+                    print(f"{prefix}替换完成 -> {final_path}")
+                else:
+                    # 原文件不是MP4
+                    if os.path.exists(final_path):
+                        print(f"{prefix}目标文件已存在，将被覆盖: {final_path}")
+
+                    # 先尝试删除原文件（如同快速模式逻辑）
+                    try:
+                        if os.path.exists(input_path):
+                            os.remove(input_path)
+                    except OSError as e:
+                        print(f"{prefix}删除原文件失败: {e}")
+
+                    os.replace(output_path, final_path)
+                    print(f"{prefix}新文件已就绪 -> {final_path}")
+
+                # 尝试恢复文件时间戳
+                if orig_stat:
+                    try:
+                        set_creation_time(final_path, orig_stat.st_ctime)
+                    except Exception:
+                        pass
+                    try:
+                        os.utime(final_path, (orig_stat.st_atime, orig_stat.st_mtime))
+                    except Exception:
+                        pass
+                    print(f"{prefix}已恢复原始文件时间戳。")
+                return 'ok'
+            except OSError as e:
+                print(f"{prefix}替换文件时发生错误: {e}")
+                # 如果替换失败，保留临时文件
+                return 'error'
+        else:
+            print(f"{prefix}校验失败：{validation_msg}")
+            print(f"{prefix}保留临时文件以供检查：{output_path}")
+            return 'error'
+    except Exception as e:
+        print(f"{prefix}校验/替换时发生错误: {e}")
+        return 'error'
+
+# 各编码器家族可稳定并行的会话数（消费级 NVENC 驱动默认限 3 路）
+ENCODER_SESSION_LIMITS = {
+    'nvenc': 3,
+    'qsv': 2,
+    'amf': 2,
+}
+
+
+def _encoder_session_limit(encoder):
+    for family, limit in ENCODER_SESSION_LIMITS.items():
+        if family in encoder:
+            return limit
+    return 1  # 软件编码：单路（多路软件编码只会互相抢核心）
+
+
+def run_batch(paths, jobs=None):
+    """转码队列管理器：N 路并行 ffmpeg（按编码器会话上限），
+    GPU 编码失败的文件单独排队到 CPU 兜底通道，
+    校验与替换在独立线程中与下一个文件的编码重叠。
+
+    Returns:
+        (成功数, 失败数)
+    """
+    from concurrent.futures import ThreadPoolExecutor, as_completed
+
+    best_encoder = get_optimal_encoder()
+    is_hw = any(f in best_encoder for f in ENCODER_SESSION_LIMITS)
+    parallel = jobs if jobs else _encoder_session_limit(best_encoder)
+    print(f"批量转码 {len(paths)} 个文件：编码器 {best_encoder}，并行 {parallel} 路")
+
+    cpu_fallback_queue = []
+    finalize_futures = []
+    ok_count = 0
+    fail_count = 0
+
+    def encode_one(path, enc):
+        label = os.path.basename(path)
+        result = convert_video_to_mp4(path, encoder=enc, label=label,
+                                      finalize_executor=finalize_pool)
+        return path, result
+
+    with ThreadPoolExecutor(max_workers=2, thread_name_prefix='finalize') as finalize_pool:
+        # GPU（或最佳编码器）通道
+        with ThreadPoolExecutor(max_workers=parallel, thread_name_prefix='encode') as encode_pool:
+            futures = {encode_pool.submit(encode_one, p, best_encoder): p for p in paths}
+            for future in as_completed(futures):
+                path, result = future.result()
+                if isinstance(result, tuple) and result[0] == 'pending':
+                    finalize_futures.append((path, result[1]))
+                elif result == 'encode_failed' and is_hw:
+                    # GPU 编码失败：排到 CPU 兜底通道
+                    print(f"[{os.path.basename(path)}] 硬件编码失败，转入 CPU 兜底队列。")
+                    cpu_fallback_queue.append(path)
+                elif result == 'ok':
+                    ok_count += 1
+                else:
+                    fail_count += 1
+
+        # CPU 兜底通道：与 GPU 通道分开调度（软件编码单路，不与硬件会话抢资源）
+        if cpu_fallback_queue:
+            print(f"CPU 兜底转码 {len(cpu_fallback_queue)} 个文件 (libx264)...")
+            for path in cpu_fallback_queue:
+                result = convert_video_to_mp4(path, encoder='libx264',
+                                              label=os.path.basename(path),
+                                              finalize_executor=finalize_pool)
+                if isinstance(result, tuple) and result[0] == 'pending':
+                    finalize_futures.append((path, result[1]))
+                elif result == 'ok':
+                    ok_count += 1
+                else:
+                    fail_count += 1
+
+        # 等待所有异步校验+替换完成
+        for path, future in finalize_futures:
+            if future.result() == 'ok':
+                ok_count += 1
+            else:
+                fail_count += 1
+
+    print(f"批量转码完成：成功 {ok_count}，失败 {fail_count}")
+    return ok_count, fail_count
+
 
 if __name__ == '__main__':
-    if len(sys.argv) > 1:
-        video_file_path = sys.argv[1]
-        convert_video_to_mp4(video_file_path)
+    args = [a for a in sys.argv[1:]]
+    jobs = None
+    if '--jobs' in args:
+        idx = args.index('--jobs')
+        try:
+            jobs = int(args[idx + 1])
+            del args[idx:idx + 2]
+        except (IndexError, ValueError):
+            print("错误：--jobs 参数后面需要一个整数。")
+            sys.exit(1)
+
+    if len(args) > 1:
+        # 批量模式：多个文件经转码队列并行处理
+        ok, failed = run_batch(args, jobs=jobs)
+        sys.exit(0 if failed == 0 else 1)
+    elif len(args) == 1:
+        video_file_path = args[0]
+        result = convert_video_to_mp4(video_file_path)
+        sys.exit(0 if result == 'ok' else 1)
     else:
         print("请提供一个视频文件路径作为命令行参数。例如：python convert2mp4.py /path/to/your/video.mov")
\ No newline at end of file
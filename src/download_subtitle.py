@@ -33,6 +33,9 @@ import sys
 import json
 
 import argparse
+import time
+import threading
+from concurrent.futures import ThreadPoolExecutor
 from subliminal import download_best_subtitles, Movie, region
 from babelfish import Language
 
@@ -41,6 +44,58 @@ headers = {
 }
 base_url = "https://www.subtitlecat.com"
 
+# 共享会话池：批量模式下所有请求复用同一个 keep-alive 连接池
+session = requests.Session()
+session.headers.update(headers)
+
+# ============================================================
+# 解析器缓存：title/IMDb-ID → 各提供方的搜索结果（带 TTL）
+# ============================================================
+# 重试某个文件时直接跳过搜索阶段；整季补字幕不再对每集重复搜索。
+RESOLVER_CACHE_PATH = os.path.join('.', 'cache', 'subtitles', 'resolver_cache.json')
+RESOLVER_CACHE_TTL_SECONDS = 7 * 24 * 3600
+_resolver_cache_lock = threading.Lock()
+
+
+def _resolver_cache_key(title, imdb_id):
+    return f"{(title or '').strip().lower()}|{(imdb_id or '').strip().lower()}"
+
+
+def load_resolver_cache():
+    try:
+        with open(RESOLVER_CACHE_PATH, 'r', encoding='utf-8') as f:
+            return json.load(f)
+    except Exception:
+        return {}
+
+
+def save_resolver_cache(cache):
+    try:
+        os.makedirs(os.path.dirname(RESOLVER_CACHE_PATH), exist_ok=True)
+        with open(RESOLVER_CACHE_PATH, 'w', encoding='utf-8') as f:
+            json.dump(cache, f, ensure_ascii=False)
+    except Exception as e:
+        print(f"保存解析缓存失败: {e}", file=sys.stderr)
+
+
+def resolver_cache_get(title, imdb_id):
+    entry = load_resolver_cache().get(_resolver_cache_key(title, imdb_id))
+    if entry and time.time() - entry.get('timestamp', 0) < RESOLVER_CACHE_TTL_SECONDS:
+        return entry
+    return None
+
+
+def resolver_cache_put(title, imdb_id, provider, results):
+    # 批量模式下多个 worker 并发写缓存：读-改-写需要互斥
+    with _resolver_cache_lock:
+        cache = load_resolver_cache()
+        cache[_resolver_cache_key(title, imdb_id)] = {
+            'provider': provider,
+            'results': results,
+            'timestamp': time.time()
+        }
+        save_resolver_cache(cache)
+
 def convert_to_vtt(input_path, output_path):
     """
     Convert subtitle file to VTT format using ffmpeg.
@@ -141,10 +196,145 @@ def download_subtitles_subliminal(title, imdb_id):
         # Stop after successfully processing one subtitle
         return
 
+def _search_subtitlecat_results(keyword):
+    """Subtitle Cat 搜索（返回结果列表，供 fan-out 与缓存复用）。"""
+    search_url = f"{base_url}/index.php?search={keyword.replace(' ', '+')}"
+    search_response = session.get(search_url, timeout=20)
+    search_response.raise_for_status()
+    soup = BeautifulSoup(search_response.text, 'html.parser')
+    result_rows = soup.select('table.sub-table tr')
+
+    filtered_links = []
+    clean_keyword = re.sub(r'[^a-zA-Z0-9]', '', keyword).lower()
+    for row in result_rows:
+        link = row.find('a', href=True)
+        if not link:
+            continue
+        title = link.get_text(strip=True)
+        clean_title = re.sub(r'[^a-zA-Z0-9]', '', title).lower()
+        if clean_keyword in clean_title:
+            filtered_links.append({
+                'url': urljoin(base_url, link['href']),
+                'title': title,
+            })
+    return filtered_links
+
+
+def _search_subliminal_results(title, imdb_id, stop_event=None):
+    """subliminal 提供方探测：找到可下载字幕时返回描述列表。
+
+    subliminal 的搜索+下载是一体的；这里直接下载最佳字幕并转 VTT，
+    返回落地文件信息（与 fan-out 的"第一个可用结果"语义一致）。
+    """
+    if stop_event and stop_event.is_set():
+        return []
+    try:
+        region.configure('dogpile.cache.memory')
+    except Exception:
+        pass  # 已配置过
+
+    virtual_name = f"{title}.mkv"
+    movie = Movie(name=virtual_name, title=title, imdb_id=imdb_id)
+    subtitles = download_best_subtitles([movie], {Language('zho')}, hearing_impaired=False)
+    if stop_event and stop_event.is_set():
+        return []
+    found = []
+    subtitles_dir = os.path.join('.', 'cache', 'subtitles')
+    os.makedirs(subtitles_dir, exist_ok=True)
+    for sub in subtitles.get(movie, []):
+        safe_title = "".join(c for c in title if c.isalnum() or c in (' ', '-')).rstrip()
+        file_name = f"{safe_title.replace(' ', '_')}.{sub.language.alpha2}.srt"
+        save_path = os.path.join(subtitles_dir, file_name)
+        with open(save_path, 'wb') as f:
+            f.write(sub.content)
+        vtt_path = os.path.join(subtitles_dir, f"{os.path.splitext(file_name)[0]}.vtt")
+        if convert_to_vtt(save_path, vtt_path):
+            try:
+                os.remove(save_path)
+            except OSError:
+                pass
+            found.append({'title': title, 'path': vtt_path, 'lang': str(sub.language)})
+        break  # 第一个成功的即可
+    return found
+
+
+def search_all_providers(title, imdb_id=None, use_cache=True):
+    """并发向所有提供方发起搜索，第一个拿到可用结果的提供方获胜。
+
+    - 两个提供方在线程池中同时跑；先返回非空结果的一方置位 stop_event，
+      慢的一方在阻塞调用边界检查事件后放弃后续步骤。
+    - 结果写入解析缓存（TTL 内重试同一标题跳过搜索阶段）。
+    返回 {'success', 'provider', 'results', 'cached'}。
+    """
+    if use_cache:
+        cached = resolver_cache_get(title, imdb_id)
+        if cached:
+            return {'success': True, 'provider': cached['provider'],
+                    'results': cached['results'], 'cached': True}
+
+    stop_event = threading.Event()
+    outcome = {}
+    outcome_lock = threading.Lock()
+
+    def run_provider(name, fn):
+        try:
+            results = fn()
+        except Exception as e:
+            print(f"提供方 {name} 失败: {e}", file=sys.stderr)
+            return
+        if results:
+            with outcome_lock:
+                if not outcome:  # 第一个有结果的提供方获胜
+                    outcome['provider'] = name
+                    outcome['results'] = results
+                    stop_event.set()
+
+    providers = [('subtitlecat', lambda: _search_subtitlecat_results(title))]
+    if imdb_id:
+        providers.append(('subliminal', lambda: _search_subliminal_results(title, imdb_id, stop_event)))
+
+    with ThreadPoolExecutor(max_workers=len(providers)) as executor:
+        futures = [executor.submit(run_provider, name, fn) for name, fn in providers]
+        for future in futures:
+            future.result()
+
+    if outcome:
+        resolver_cache_put(title, imdb_id, outcome['provider'], outcome['results'])
+        return {'success': True, 'provider': outcome['provider'],
+                'results': outcome['results'], 'cached': False}
+    return {'success': False, 'provider': None, 'results': [], 'cached': False}
+
+
+def run_batch_stdin():
+    """批量模式：stdin 每行一个 JSON {"title": ..., "imdb_id": ...}，
+    经共享会话池并发处理整个目录缺字幕的文件，逐行输出 NDJSON 结果。"""
+    jobs = []
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            jobs.append(json.loads(line))
+        except json.JSONDecodeError:
+            jobs.append({'title': line})
+
+    output_lock = threading.Lock()
+
+    def process(job):
+        title = job.get('title', '')
+        result = search_all_providers(title, job.get('imdb_id'), use_cache=not job.get('force'))
+        result['title'] = title
+        with output_lock:
+            print(json.dumps(result, ensure_ascii=False), flush=True)
+
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        list(executor.map(process, jobs))
+
+
 def search_subtitlecat(keyword):
     search_url = f"{base_url}/index.php?search={keyword.replace(' ', '+')}"
     try:
-        search_response = requests.get(search_url, headers=headers)
+        search_response = session.get(search_url, timeout=20)
         search_response.raise_for_status()
         soup = BeautifulSoup(search_response.text, 'html.parser')
         result_rows = soup.select('table.sub-table tr')
@@ -169,7 +359,7 @@ def search_subtitlecat(keyword):
 
 def get_languages_subtitlecat(page_url):
     try:
-        subtitle_page_response = requests.get(page_url, headers=headers)
+        subtitle_page_response = session.get(page_url, timeout=20)
         subtitle_page_response.raise_for_status()
         subtitle_soup = BeautifulSoup(subtitle_page_response.text, 'html.parser')
         
@@ -192,7 +382,7 @@ def download_and_convert_subtitlecat(download_url, file_title, lang):
     subtitles_dir = os.path.join('.', 'cache', 'subtitles')
     os.makedirs(subtitles_dir, exist_ok=True)
     try:
-        subtitle_response = requests.get(download_url, headers=headers)
+        subtitle_response = session.get(download_url, timeout=30)
         subtitle_response.raise_for_status()
         
         file_name_base = "".join(c for c in file_title if c.isalnum() or c in (' ', '-')).rstrip().replace(' ', '_')
@@ -357,12 +547,27 @@ if __name__ == '__main__':
     parser.add_argument('--site', choices=['subtitlecat', 'subliminal'], help='The site to download subtitles from.')
     parser.add_argument('--title', help='The title of the movie/series.')
     parser.add_argument('--imdb_id', help='The IMDb ID of the movie/series (required for subliminal).')
-    parser.add_argument('--action', choices=['search', 'languages', 'download'], help='Action for subtitlecat API mode.')
+    parser.add_argument('--action', choices=['search', 'languages', 'download', 'search-all'], help='Action for subtitlecat API mode (search-all 为并发多提供方).')
+    parser.add_argument('--batch-stdin', action='store_true', help='批量模式：stdin 每行一个 JSON 任务，NDJSON 输出。')
+    parser.add_argument('--no-cache', action='store_true', help='绕过解析缓存。')
     parser.add_argument('--url', help='URL for languages or download action.')
     parser.add_argument('--lang', help='Language for download action.')
 
     args = parser.parse_args()
 
+    # 批量模式：整目录的缺字幕文件经一个进程/共享会话池处理
+    if args.batch_stdin:
+        run_batch_stdin()
+        sys.exit(0)
+
+    # 并发多提供方搜索（第一个可用结果获胜）
+    if args.action == 'search-all':
+        if not args.title:
+            print(json.dumps({"success": False, "error": "Title is required for search-all action."}))
+            sys.exit(1)
+        print(json.dumps(search_all_providers(args.title, args.imdb_id, use_cache=not args.no_cache), ensure_ascii=False))
+        sys.exit(0)
+
     # API mode for subtitlecat
     if args.site == 'subtitlecat' and args.action:
         if args.action == 'search':
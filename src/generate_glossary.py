@@ -6,9 +6,13 @@
 
 import webvtt
 import logging
+import json
+import hashlib
+import threading
 from pathlib import Path
 from typing import List, Dict
 import collections
+from concurrent.futures import ThreadPoolExecutor
 from tqdm import tqdm
 
 # 假设 VTTCorrector 类定义在 process_subtitle 中
@@ -76,33 +80,111 @@ class GlossaryGenerator:
             self.dic_counter[entry] += 1
 
 
-    def generate_from_vtt(self, vtt_file_path: str) -> bool:
+    def _map_extract(self, groups):
+        """Map 阶段：块级提取提示并行派发，按完成数上报进度。
+
+        在线模型按 concurrent_threads 并行（默认 4）；本地模型经
+        execute_raw_prompt 路由到共享 InferenceScheduler——多线程提交
+        只是把提示排进调度器队列（与翻译任务合批、公平轮转），
+        模型本身始终由调度器线程串行/合批驱动。
+        返回按块顺序排列的响应列表（失败的块为空串）。
+        """
+        texts = []
+        for group in groups:
+            text_chunk = "\n".join(caption.text.strip() for caption in group)
+            if text_chunk:
+                texts.append(text_chunk)
+
+        if self.corrector.online_mode:
+            workers = int(self.corrector.model_config.get("concurrent_threads", 4)) or 1
+        elif getattr(self.corrector, 'inference_scheduler', None) is not None:
+            workers = 4  # 仅决定同时排队的提示数；执行由调度器合批
+        else:
+            workers = 1  # 无调度器（独立 CLI 场景）：直接驱动模型，保持单线程
+
+        total = len(texts)
+        responses = [""] * total
+        done_count = [0]
+        progress_lock = threading.Lock()
+
+        def run_one(i):
+            prompt, system_prompt = self._create_glossary_prompt(texts[i])
+            try:
+                responses[i] = self.corrector.execute_raw_prompt(prompt, system_prompt=system_prompt)
+            except Exception as e:
+                logger.warning(f"第 {i + 1} 块术语提取失败: {e}")
+            with progress_lock:
+                done_count[0] += 1
+                _report_progress("术语表", done_count[0], total)
+
+        logger.info(f"Map 阶段：{total} 块并行提取（workers={workers}）...")
+        with ThreadPoolExecutor(max_workers=workers) as executor:
+            list(tqdm(executor.map(run_one, range(total)), total=total, desc="生成术语表"))
+        return responses
+
+    @staticmethod
+    def _series_paths(series: str):
+        """返回某个系列的术语表文件与清单文件路径。"""
+        output_dir = Path("./cache/subtitles/glossary")
+        safe = "".join(c for c in series if c not in r'\/:*?"<>|').strip() or "series"
+        return output_dir / f"series_{safe}.txt", output_dir / f"series_{safe}.manifest.json"
+
+    @staticmethod
+    def _file_content_hash(path: str) -> str:
+        h = hashlib.md5()
+        with open(path, 'rb') as fh:
+            for chunk in iter(lambda: fh.read(8192), b''):
+                h.update(chunk)
+        return h.hexdigest()
+
+    def generate_from_vtt(self, vtt_file_path: str, series: str = None) -> bool:
         """
         从VTT文件生成术语表，并将其保存在 .\cache\subtitles\glossary\ 目录下
+
+        传入 series 时启用按系列的增量模式：已合并过的集数直接跳过，
+        新集数只做自己的 Map 提取，Reduce 时与系列清单中累计的计数合并，
+        系列术语表与本集的 per-VTT 术语表同时更新。
         """
         try:
             logger.info(f"开始从 {vtt_file_path} 生成术语表...")
+
+            # 系列增量模式：载入既有计数，已处理过的集数直接跳过
+            manifest = None
+            content_hash = None
+            if series:
+                _, manifest_path = self._series_paths(series)
+                content_hash = self._file_content_hash(vtt_file_path)
+                if manifest_path.exists():
+                    try:
+                        manifest = json.loads(manifest_path.read_text(encoding='utf-8'))
+                    except Exception:
+                        manifest = None
+                if manifest is None:
+                    manifest = {"files": {}, "counter": {}}
+                if manifest["files"].get(content_hash):
+                    logger.info(f"该集已合并进系列术语表 '{series}'，跳过。")
+                    return True
+                # 用系列累计计数作为 Reduce 起点
+                for key, count in manifest["counter"].items():
+                    parts = key.split('\t')
+                    if len(parts) == 3:
+                        entry = (parts[0], parts[1], parts[2])
+                        self.dic_counter[entry] = count
+                        self.dic_list.append(list(entry))
+
             vtt = webvtt.read(vtt_file_path)
-            
+
             # 1. 文本分块
             groups = self.corrector._group_captions(vtt.captions)
-            
-            # 2. 调用LLM处理每个文本块
             logger.info(f"将字幕分为 {len(groups)} 组进行处理...")
-            total_groups = len(groups)
-            for i, group in enumerate(tqdm(groups, desc="生成术语表")):
-                text_segments = [caption.text.strip() for caption in group]
-                text_chunk = "\n".join(text_segments)
-                
-                if not text_chunk:
-                    continue
-
-                prompt, system_prompt = self._create_glossary_prompt(text_chunk)
-                response = self.corrector.execute_raw_prompt(prompt, system_prompt=system_prompt)
-                self._parse_llm_response(response)
-                
-                # Report progress after processing each group
-                _report_progress("术语表", i + 1, total_groups)
+
+            # 2. Map：并行提取各块术语
+            responses = self._map_extract(groups)
+
+            # Reduce：合并/去重所有块的提取结果
+            for response in responses:
+                if response:
+                    self._parse_llm_response(response)
 
             # 3. 后处理
             final_list = []
@@ -129,7 +211,20 @@ class GlossaryGenerator:
                 f.write("# 格式: 日文原词\t中文翻译\t备注\n")
                 for item in final_list:
                     f.write(f"{item[0]}\t{item[1]}\t{item[2]}\n")
-            
+
+            # 7. 系列模式：同步更新系列术语表与清单（累计计数持久化，支持增量扩展）
+            if series:
+                series_file, manifest_path = self._series_paths(series)
+                with open(series_file, "w", encoding="utf-8") as f:
+                    f.write(f"# VTT-Auto-Glossary (series: {series}): Generated by LLM\n")
+                    f.write("# 格式: 日文原词\t中文翻译\t备注\n")
+                    for item in final_list:
+                        f.write(f"{item[0]}\t{item[1]}\t{item[2]}\n")
+                manifest["files"][content_hash] = True
+                manifest["counter"] = {f"{s}\t{d}\t{n}": c for (s, d, n), c in self.dic_counter.items()}
+                manifest_path.write_text(json.dumps(manifest, ensure_ascii=False), encoding='utf-8')
+                logger.info(f"系列术语表已更新: {series_file}")
+
             logger.info(f"术语表生成完成，共 {len(final_list)} 个词条，已保存至: {output_file_path}")
             return True
 
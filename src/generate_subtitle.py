@@ -345,14 +345,18 @@ def post_process_subtitles(segments, merge_threshold=1.0):
 def run_transcription(audio_file_path, model_source='pretrained', model_identifier='large-v3', 
                       task='transcribe', language=None, vad_filter=False, vad_threshold=None, 
                       condition_on_previous_text=False, transcribe_kwargs_json=None, 
-                      output_dir='./cache/subtitles/', merge_threshold=1.0, 
-                      dense_subtitles=False, max_chars_per_line=30, 
-                      loaded_model=None):
-    
+                      output_dir='./cache/subtitles/', merge_threshold=1.0,
+                      dense_subtitles=False, max_chars_per_line=30,
+                      loaded_model=None, preprocessed_audio_path=None):
+
     start_timestamp = int(datetime.datetime.now().timestamp())
-    
-    # Preprocess
-    processed_audio_path = preprocess_audio_for_vad(audio_file_path, output_dir)
+
+    # Preprocess（流水线模式下由调用方在 GPU 忙碌时提前完成，这里直接复用）
+    if preprocessed_audio_path and os.path.exists(preprocessed_audio_path):
+        print(f"[Pre-process] Reusing preprocessed audio: {preprocessed_audio_path}")
+        processed_audio_path = preprocessed_audio_path
+    else:
+        processed_audio_path = preprocess_audio_for_vad(audio_file_path, output_dir)
     
     # Load model if not provided
     if loaded_model:
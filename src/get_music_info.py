@@ -54,6 +54,9 @@ import musicbrainzngs
 import sqlite3
 import difflib
 import struct
+import time
+import atexit
+from concurrent.futures import ThreadPoolExecutor
 from mutagen import File
 from mutagen.flac import FLAC, Picture
 from mutagen.mp3 import MP3
@@ -202,10 +205,52 @@ def _extract_wav_cover(file_path):
     
     return None
 
+# --- Database helpers ---
+# 写入吞吐优化：WAL 日志模式 + 进程内长驻连接 + 批量事务。
+# WAL 下写事务不阻塞其他进程（Node 侧 worker、播放器 UI 的查询）的读取；
+# 批量提交让目录刮削不再为每首曲目付出一次 fsync。
+_DB_CONN = None
+_DB_PENDING_WRITES = 0
+_DB_LAST_COMMIT = 0.0
+DB_COMMIT_EVERY_N = 16      # 每 N 次写入提交一次
+DB_COMMIT_EVERY_SECONDS = 2.0  # 或距上次提交超过 T 秒
+
+
+def get_db_connection():
+    """获取进程内长驻的数据库连接（首次调用时启用 WAL 并注册退出时刷盘）。"""
+    global _DB_CONN, _DB_LAST_COMMIT
+    if _DB_CONN is None:
+        os.makedirs(CACHE_DB_DIR, exist_ok=True)
+        _DB_CONN = sqlite3.connect(DB_PATH)
+        _DB_CONN.execute("PRAGMA journal_mode=WAL")
+        _DB_CONN.execute("PRAGMA synchronous=NORMAL")
+        _DB_LAST_COMMIT = time.monotonic()
+        atexit.register(flush_db_writes)
+    return _DB_CONN
+
+
+def flush_db_writes():
+    """提交所有挂起的写入（批量事务的边界，进程退出时也会调用）。"""
+    global _DB_PENDING_WRITES, _DB_LAST_COMMIT
+    if _DB_CONN is not None and _DB_PENDING_WRITES > 0:
+        try:
+            _DB_CONN.commit()
+        except sqlite3.Error as e:
+            print(f"Error committing pending DB writes: {e}", file=sys.stderr)
+        _DB_PENDING_WRITES = 0
+        _DB_LAST_COMMIT = time.monotonic()
+
+
+def _maybe_commit():
+    """达到批量阈值（条数或时间）时提交。"""
+    if _DB_PENDING_WRITES >= DB_COMMIT_EVERY_N or \
+            time.monotonic() - _DB_LAST_COMMIT >= DB_COMMIT_EVERY_SECONDS:
+        flush_db_writes()
+
+
 def init_db():
     """Initializes the database and creates the table if it doesn't exist."""
-    os.makedirs(CACHE_DB_DIR, exist_ok=True)
-    conn = sqlite3.connect(DB_PATH)
+    conn = get_db_connection()
     cursor = conn.cursor()
     cursor.execute('''
         CREATE TABLE IF NOT EXISTS music_info (
@@ -217,17 +262,25 @@ def init_db():
             last_updated TIMESTAMP DEFAULT CURRENT_TIMESTAMP
         )
     ''')
+    # 负结果缓存：已知搜不到的曲目在 TTL 内不再重试（整库扫描不再反复打 API）
+    cursor.execute('''
+        CREATE TABLE IF NOT EXISTS netease_negative_cache (
+            search_key TEXT PRIMARY KEY,
+            last_attempt TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+        )
+    ''')
     conn.commit()
-    conn.close()
+
 
 def save_info_to_db(filepath, info):
-    """Saves or updates music info in the database."""
+    """Saves or updates music info in the database (batched commit)."""
+    global _DB_PENDING_WRITES
     if not info:
         return
-    
+
     abs_filepath = os.path.abspath(filepath)
 
-    conn = sqlite3.connect(DB_PATH)
+    conn = get_db_connection()
     cursor = conn.cursor()
     cursor.execute('''
         INSERT INTO music_info (filepath, title, artist, album, cover_path, last_updated)
@@ -245,16 +298,15 @@ def save_info_to_db(filepath, info):
         info.get('album'),
         info.get('cover_path')
     ))
-    conn.commit()
-    conn.close()
+    _DB_PENDING_WRITES += 1
+    _maybe_commit()
     print(f"Saved info for '{abs_filepath}' to database.", file=sys.stderr)
 
 
-def main():
-    """Main function to process the audio file."""
-    # Setup argparse
+def build_arg_parser():
+    """构建命令行参数解析器（单次模式与 --serve 常驻模式共用）。"""
     parser = argparse.ArgumentParser(description="Get music info from MusicBrainz or Netease and save it.")
-    parser.add_argument("filepath", help="Path to the audio file.")
+    parser.add_argument("filepath", nargs='?', default=None, help="Path to the audio file.")
     parser.add_argument("--source", choices=['musicbrainz', 'netease', 'local'], default='local', help="The source to get music info from.")
     parser.add_argument("--no-write", action="store_true", help="Do not write the metadata (cover, ID3 tags) back to the audio file.")
     parser.add_argument("--write-db", action="store_true", help="Write the music info to the local database.")
@@ -267,30 +319,25 @@ def main():
     parser.add_argument("--force-fetch", action="store_true", help="Force re-fetching from the internet and overwrite local cache.")
     parser.add_argument("--only", choices=['all', 'lyrics', 'cover', 'info'], default='all', help="Only fetch a specific type: lyrics, cover, info, or all.")
     parser.add_argument("--skip-existing", action="store_true", help="Skip files that already exist in the database.")
-    
-    args = parser.parse_args()
+    parser.add_argument("--serve", action="store_true", help="Run as a persistent worker: read NDJSON requests from stdin, write NDJSON responses to stdout.")
+    return parser
 
-    # Decode the filepath if it's URL-encoded
-    # The path from the Node.js server is already decoded, no need to unquote again.
-    # args.filepath = urllib.parse.unquote(args.filepath)
-    # Ensure cache directories exist
-    os.makedirs(CACHE_LYRICS_DIR, exist_ok=True)
-    os.makedirs(CACHE_COVERS_DIR, exist_ok=True)
-    init_db()
 
+def process_request(args):
+    """处理单个元数据请求，返回将要输出的 JSON 字典（无结果时返回 None）。
+
+    所有诊断信息走 stderr，因此该函数在 --serve 常驻模式下可以安全复用：
+    stdout 始终只承载协议数据。
+    """
     # 跳过数据库中已存在的记录（批量刮削时使用）
     if args.skip_existing:
         abs_fp = os.path.abspath(args.filepath)
-        conn = sqlite3.connect(DB_PATH)
-        cursor = conn.cursor()
+        cursor = get_db_connection().cursor()
         cursor.execute("SELECT filepath FROM music_info WHERE filepath = ?", (abs_fp,))
         row = cursor.fetchone()
-        conn.close()
         if row:
-            if args.json_output:
-                print(json.dumps({"skipped": True, "reason": "already_in_db"}))
-            sys.exit(0)
-    
+            return {"skipped": True, "reason": "already_in_db"}
+
     # Setup MusicBrainz client if needed
     if args.source == 'musicbrainz':
         # Ensure app name/version are not empty (musicbrainzngs requires non-empty values)
@@ -317,8 +364,7 @@ def main():
             print("Warning: MusicBrainz client_id/client_secret not configured; proceeding unauthenticated.", file=sys.stderr)
 
     if not os.path.exists(args.filepath):
-        print(f"Error: File not found at {args.filepath}", file=sys.stderr)
-        sys.exit(1)
+        raise FileNotFoundError(f"File not found at {args.filepath}")
 
     try:
         print(f"Processing file: {args.filepath}", file=sys.stderr)
@@ -392,7 +438,7 @@ def main():
             # If lyrics are requested and not cached, try netease as fallback
             if need_lyrics and not music_info.get('lyrics'):
                 print("Source is local but no cached lyrics found (or forced). Trying Netease for lyrics.", file=sys.stderr)
-                netease_info = search_netease(track_info, bilingual=not args.original_lyrics, limit=args.limit, force_match=args.force_match)
+                netease_info = search_netease(track_info, bilingual=not args.original_lyrics, limit=args.limit, force_match=args.force_match, use_negative_cache=not args.force_fetch)
                 if netease_info and netease_info.get('lyrics'):
                     music_info['lyrics'] = netease_info.get('lyrics')
 
@@ -402,7 +448,7 @@ def main():
             should_fetch_from_netease = need_info or (need_lyrics and not cached_lyrics) or (need_cover and not cached_cover_filename)
             
             if should_fetch_from_netease:
-                netease_info = search_netease(track_info, bilingual=not args.original_lyrics, limit=args.limit, force_match=args.force_match)
+                netease_info = search_netease(track_info, bilingual=not args.original_lyrics, limit=args.limit, force_match=args.force_match, use_negative_cache=not args.force_fetch)
                 if netease_info:
                     if need_info:
                         music_info['title'] = netease_info.get('title') or music_info['title']
@@ -467,24 +513,140 @@ def main():
             if need_lyrics:
                 final_lyrics_filename = lyrics_filename or cached_lyrics_filename
 
-            # Output JSON if requested
-            if args.json_output:
-                json_info = music_info.copy()
-                if 'cover_data' in json_info:
-                    del json_info['cover_data']
-                if final_cover_filename:
-                    json_info['cover_filename'] = final_cover_filename
-                if final_lyrics_filename:
-                    json_info['lyrics_filename'] = final_lyrics_filename
-                # If lyrics came from cache, make sure they are in the output (only if lyrics were requested)
-                if need_lyrics and cached_lyrics and 'lyrics' not in json_info and not args.force_fetch:
-                    json_info['lyrics'] = cached_lyrics
-                # Remove lyrics from output if they were not requested
-                if not need_lyrics and 'lyrics' in json_info:
-                    del json_info['lyrics']
-                print(json.dumps(json_info, indent=4, ensure_ascii=False))
+            # Build the JSON result (printed by main(), or sent over the wire in --serve mode)
+            json_info = music_info.copy()
+            if 'cover_data' in json_info:
+                del json_info['cover_data']
+            if final_cover_filename:
+                json_info['cover_filename'] = final_cover_filename
+            if final_lyrics_filename:
+                json_info['lyrics_filename'] = final_lyrics_filename
+            # If lyrics came from cache, make sure they are in the output (only if lyrics were requested)
+            if need_lyrics and cached_lyrics and 'lyrics' not in json_info and not args.force_fetch:
+                json_info['lyrics'] = cached_lyrics
+            # Remove lyrics from output if they were not requested
+            if not need_lyrics and 'lyrics' in json_info:
+                del json_info['lyrics']
+            return json_info
+    except FileNotFoundError:
+        raise
     except Exception as e:
         print(f"An unexpected error occurred in main: {e}", file=sys.stderr)
+    return None
+
+
+def batch_db_lookup(paths):
+    """批量查询缓存数据库：一次连接解决整个播放列表的缓存命中。
+
+    返回 (found, missing)：found 为 {绝对路径: 行数据}，missing 为未入库的路径列表。
+    """
+    found = {}
+    missing = []
+    cursor = get_db_connection().cursor()
+    # SQLite 变量数量有限制（默认 999），分块执行 IN 查询
+    CHUNK = 500
+    rows_by_path = {}
+    abs_paths = [os.path.abspath(p) for p in paths]
+    for i in range(0, len(abs_paths), CHUNK):
+        chunk = abs_paths[i:i + CHUNK]
+        placeholders = ','.join('?' * len(chunk))
+        cursor.execute(
+            f"SELECT filepath, title, artist, album, cover_path FROM music_info WHERE filepath IN ({placeholders})",
+            chunk
+        )
+        for row in cursor.fetchall():
+            rows_by_path[row[0]] = {
+                "title": row[1],
+                "artist": row[2],
+                "album": row[3],
+                "cover_path": row[4]
+            }
+    for orig, abs_p in zip(paths, abs_paths):
+        if abs_p in rows_by_path:
+            found[orig] = rows_by_path[abs_p]
+        else:
+            missing.append(orig)
+    return found, missing
+
+
+def serve_stdio(parser):
+    """常驻 worker 模式：从 stdin 逐行读取 NDJSON 请求，在 stdout 逐行写回响应。
+
+    请求格式:  {"id": <any>, "argv": ["<filepath>", "--source", "netease", ...]}
+               {"id": <any>, "op": "batch_db_lookup", "paths": ["<abs1>", ...]}
+    响应格式:  {"id": <any>, "success": true, "data": {...}}
+               {"id": <any>, "success": true, "found": {...}, "missing": [...]}
+               {"id": <any>, "success": false, "error": "..."}
+
+    argv 与单次调用时传给本脚本的命令行参数完全一致（不含脚本名），
+    这样 Node.js 侧可以复用既有的参数组装逻辑，只是不再为每个请求冷启动解释器。
+    诊断信息全部走 stderr，stdout 只承载协议数据。
+    """
+    print("get_music_info.py worker ready (serve mode).", file=sys.stderr)
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        req_id = None
+        try:
+            request = json.loads(line)
+            req_id = request.get('id')
+            # 批量缓存查询：整个播放列表只开一次数据库连接
+            if request.get('op') == 'batch_db_lookup':
+                paths = request.get('paths')
+                if not isinstance(paths, list):
+                    raise ValueError("batch_db_lookup request is missing 'paths' list")
+                found, missing = batch_db_lookup(paths)
+                print(json.dumps({"id": req_id, "success": True, "found": found, "missing": missing}, ensure_ascii=False), flush=True)
+                continue
+            argv = request.get('argv')
+            if not isinstance(argv, list):
+                raise ValueError("request is missing 'argv' list")
+            # 防止递归进入 serve 模式
+            argv = [a for a in argv if a != '--serve']
+            try:
+                req_args = parser.parse_args(argv)
+            except SystemExit:
+                raise ValueError(f"invalid argv: {argv}")
+            if not req_args.filepath:
+                raise ValueError("missing filepath in argv")
+            result = process_request(req_args)
+            response = {"id": req_id, "success": True, "data": result}
+        except Exception as e:
+            print(f"Error processing serve request: {e}", file=sys.stderr)
+            response = {"id": req_id, "success": False, "error": str(e)}
+        print(json.dumps(response, ensure_ascii=False), flush=True)
+        _maybe_commit()
+
+
+def main():
+    """Main function to process the audio file."""
+    parser = build_arg_parser()
+    args = parser.parse_args()
+
+    # Decode the filepath if it's URL-encoded
+    # The path from the Node.js server is already decoded, no need to unquote again.
+    # args.filepath = urllib.parse.unquote(args.filepath)
+    # Ensure cache directories exist
+    os.makedirs(CACHE_LYRICS_DIR, exist_ok=True)
+    os.makedirs(CACHE_COVERS_DIR, exist_ok=True)
+    init_db()
+
+    if args.serve:
+        serve_stdio(parser)
+        return
+
+    if not args.filepath:
+        parser.error("filepath is required unless --serve is specified")
+
+    try:
+        result = process_request(args)
+    except FileNotFoundError as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    if args.json_output and result is not None:
+        print(json.dumps(result, indent=4, ensure_ascii=False))
 
 # --- Local File Functions ---
 
@@ -673,7 +835,7 @@ def get_mb_cover_art(release_id):
 
 # --- Netease Functions ---
 
-def search_netease(track_info, bilingual=True, limit=5, force_match=False, query_template="{artist} {title}"):
+def search_netease(track_info, bilingual=True, limit=5, force_match=False, query_template="{artist} {title}", use_negative_cache=True):
     """
     Searches Netease Music for track information.
     """
@@ -684,8 +846,8 @@ def search_netease(track_info, bilingual=True, limit=5, force_match=False, query
     artist = track_info.get('artist', '')
     title = track_info.get('title', '')
     album = track_info.get('album', '')
-    
-    lyrics, cover_url, song_info = try_netease_api(artist, title, album, bilingual=bilingual, limit=limit, force_match=force_match)
+
+    lyrics, cover_url, song_info = try_netease_api(artist, title, album, bilingual=bilingual, limit=limit, force_match=force_match, use_negative_cache=use_negative_cache)
     
     if not song_info:
         return None
@@ -719,8 +881,60 @@ def correct_lrc_format(lrc_text):
     corrected_text = pattern.sub(r'\1\3', lrc_text)
     return corrected_text
 
-def try_netease_api(artist, title, album, bilingual=True, limit=5, force_match=False):
+# 负结果缓存的有效期（天）：过期后允许重试（曲库可能上新）
+NEGATIVE_CACHE_TTL_DAYS = 7
+
+
+def _negative_cache_key(artist, title, album):
+    return f"{(artist or '').strip().lower()}|{(title or '').strip().lower()}|{(album or '').strip().lower()}"
+
+
+def is_negative_cached(key):
+    """检查该查询是否命中负结果缓存（TTL 内的已知无匹配）。"""
+    try:
+        cursor = get_db_connection().cursor()
+        cursor.execute(
+            "SELECT 1 FROM netease_negative_cache WHERE search_key = ? "
+            "AND last_attempt > datetime('now', ?)",
+            (key, f'-{NEGATIVE_CACHE_TTL_DAYS} days')
+        )
+        return cursor.fetchone() is not None
+    except sqlite3.Error:
+        return False
+
+
+def record_negative_result(key):
+    global _DB_PENDING_WRITES
+    try:
+        cursor = get_db_connection().cursor()
+        cursor.execute(
+            "INSERT OR REPLACE INTO netease_negative_cache (search_key, last_attempt) VALUES (?, CURRENT_TIMESTAMP)",
+            (key,)
+        )
+        _DB_PENDING_WRITES += 1
+        _maybe_commit()
+    except sqlite3.Error as e:
+        print(f"Error recording negative cache entry: {e}", file=sys.stderr)
+
+
+def clear_negative_result(key):
+    global _DB_PENDING_WRITES
+    try:
+        cursor = get_db_connection().cursor()
+        cursor.execute("DELETE FROM netease_negative_cache WHERE search_key = ?", (key,))
+        _DB_PENDING_WRITES += 1
+        _maybe_commit()
+    except sqlite3.Error:
+        pass
+
+
+def try_netease_api(artist, title, album, bilingual=True, limit=5, force_match=False, use_negative_cache=True):
     """Attempts to get song info from Netease API."""
+    # 负结果缓存：已知搜不到的曲目直接跳过（--force-fetch 时绕过）
+    neg_key = _negative_cache_key(artist, title, album)
+    if use_negative_cache and is_negative_cached(neg_key):
+        print(f"Negative cache hit for '{neg_key}', skipping Netease search.", file=sys.stderr)
+        return None, None, None
     try:
         search_url = "http://music.163.com/api/search/get/web"
         headers = {
@@ -863,12 +1077,11 @@ def try_netease_api(artist, title, album, bilingual=True, limit=5, force_match=F
         # Accumulate debug rows for printing later
         all_results_debug = []
 
-        # Try each variant until we find a confident match
-        # Keep track of which variant index we're testing so we can avoid early-stop for the first 3 attempts
-        for variant_index, v in enumerate(variants, start=1):
+        def query_and_score(v):
+            """查询单个变体并为所有候选打分（在线程池中并行执行）。"""
             v = v.strip()
             if not v:
-                continue
+                return v, []
             print(f"DEBUG: Netease search term: '{v}'", file=sys.stderr)
             params = {
                 's': v,
@@ -876,14 +1089,14 @@ def try_netease_api(artist, title, album, bilingual=True, limit=5, force_match=F
                 'limit': limit
             }
             try:
-                resp = requests.get(search_url, params=params, headers=headers)
+                resp = requests.get(search_url, params=params, headers=headers, timeout=10)
                 result = resp.json()
             except Exception as e:
                 print(f"Netease request error for term '{v}': {e}", file=sys.stderr)
-                continue
+                return v, []
 
             if not result.get('result') or not result['result'].get('songs'):
-                continue
+                return v, []
 
             songs = result['result']['songs']
             results_with_scores = []
@@ -1056,44 +1269,50 @@ def try_netease_api(artist, title, album, bilingual=True, limit=5, force_match=F
                     'weights': (round(dynamic_title_weight,3), round(dynamic_artist_weight,3), round(dynamic_album_weight,3))
                 }})
 
-            if results_with_scores:
-                # sort and keep best for this variant
+            return v, results_with_scores
+
+        # 并行驱动：变体按波次（一波 3 个）并发查询+打分；
+        # 每波结束后做一次早停检查——高置信度匹配（可配置阈值）
+        # 直接短路剩余变体。原先难匹配曲目串行跑完全部变体要 10 秒以上，
+        # 现在延迟大约压缩为波次数 × 单请求延迟。
+        EARLY_STOP_THRESHOLD = float(config.get('netease', {}).get('early_stop_threshold', 0.6))
+        WAVE_SIZE = 3
+        for wave_start in range(0, len(variants), WAVE_SIZE):
+            wave = variants[wave_start:wave_start + WAVE_SIZE]
+            with ThreadPoolExecutor(max_workers=len(wave)) as executor:
+                wave_results = list(executor.map(query_and_score, wave))
+
+            force_match_pick = None
+            for v, results_with_scores in wave_results:
+                if not results_with_scores:
+                    continue
                 best_result = max(results_with_scores, key=lambda x: x['score'])
-                best_score = best_result['score']
-                # collect debug rows
                 for r in results_with_scores:
-                    s = r['song']
-                    all_results_debug.append((s, r['score'], r.get('dbg')))
-
-                # Update the best overall seen so far
-                if not best_overall or best_score > best_overall['score']:
+                    all_results_debug.append((r['song'], r['score'], r.get('dbg')))
+                # force_match 语义保持：取第一个（优先级最高的）有结果的变体
+                if force_match and force_match_pick is None:
+                    force_match_pick = best_result
+                if not best_overall or best_result['score'] > best_overall['score']:
                     best_overall = best_result
 
-                # Early-stop logic:
-                # - If force_match is set, stop immediately.
-                # - For the first 3 variants: do NOT early-stop per-variant. After finishing the 3rd variant,
-                #   evaluate the best score among them and early-stop once if it meets threshold.
-                # - For subsequent variants (4th and later): evaluate per-variant early-stop using this variant's best_score.
-                EARLY_STOP_THRESHOLD = 0.6
-                if force_match:
-                    best_song = best_result['song']
-                    break
+            if force_match and force_match_pick:
+                best_overall = force_match_pick
+                best_song = force_match_pick['song']
+                break
 
-                if variant_index == 3:
-                    # One-time check after the first 3 attempts using the best score among them
-                    if best_overall and best_overall['score'] >= EARLY_STOP_THRESHOLD:
-                        best_song = best_overall['song']
-                        break
-
-                if variant_index > 3 and best_score >= EARLY_STOP_THRESHOLD:
-                    best_overall = best_result
-                    best_song = best_result['song']
-                    break
+            if best_overall and best_overall['score'] >= EARLY_STOP_THRESHOLD:
+                best_song = best_overall['song']
+                break
 
         # If no variant produced results
         if not best_overall:
+            if use_negative_cache:
+                record_negative_result(neg_key)
             return None, None, None
 
+        # 找到匹配：清除可能存在的过期负缓存记录
+        clear_negative_result(neg_key)
+
         best_song = best_overall['song']
         results_with_scores = [
             {'song': s, 'score': sc, 'dbg': dbg if isinstance(dbg, dict) else {}} 
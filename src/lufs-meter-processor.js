@@ -34,6 +34,9 @@
 
 import { initSync, LufsMeter } from '/audio_processor/pkg/audio_processor.js';
 
+// 每累计多少个 128 采样量子才跨一次 wasm 边界（通过暂存缓冲区排空）
+const DEFAULT_DRAIN_QUANTA = 8;
+
 // ============================================================
 // LufsMeterProcessor —— AudioWorkletProcessor 实现
 // ============================================================
@@ -53,6 +56,16 @@ class LufsMeterProcessor extends AudioWorkletProcessor {
         this._lastPostTime = -1;
         this._updateIntervalSec = (options?.processorOptions?.updateIntervalMs ?? 50) / 1000;
 
+        // 暂存缓冲区模式：worklet 直接写入 wasm 线性内存，每 drainQuanta
+        // 个量子才调用一次 process_staged（减少 8-16× 的 FFI 跨界和切片复制）
+        this._drainQuanta = options?.processorOptions?.drainQuanta ?? DEFAULT_DRAIN_QUANTA;
+        this._wasm = null;          // initSync 返回的 wasm exports（含 memory）
+        this._stagingCapacity = 0;  // 暂存区容量（帧）
+        this._stagedFrames = 0;     // 已写入待处理的帧数
+        this._stagedQuanta = 0;     // 已写入的量子数
+        this._viewL = null;         // wasm 内存上的 Float32Array 视图
+        this._viewR = null;
+
         // 处理来自主线程的消息
         this.port.onmessage = (event) => {
             const { type, wasmBuffer } = event.data;
@@ -62,8 +75,19 @@ class LufsMeterProcessor extends AudioWorkletProcessor {
                     if (wasmBuffer) {
                         try {
                             // 使用推荐的对象参数形式以避免弃用警告
-                            initSync({ module: wasmBuffer });
+                            this._wasm = initSync({ module: wasmBuffer });
                             this._meter = new LufsMeter(sampleRate);
+                            // 暂存缓冲区模式（wasm 构建包含该 API 时启用）
+                            if (typeof this._meter.staging_capacity === 'function' && this._wasm?.memory) {
+                                this._stagingCapacity = this._meter.staging_capacity();
+                                this._refreshStagingViews();
+                                console.log('[LUFS Worklet] Staging buffer mode enabled, capacity:', this._stagingCapacity);
+                            } else {
+                                // 旧版 wasm 构建：缺少暂存缓冲区/True Peak 导出，
+                                // 退回逐量子 FFI。重新运行 src/audio_processor/build-wasm.sh
+                                // 并提交 pkg/ 以启用这些特性。
+                                console.warn('[LUFS Worklet] wasm build is stale (no staging/true-peak exports); falling back to per-quantum FFI. Re-run src/audio_processor/build-wasm.sh and commit pkg/.');
+                            }
                             this._ready = true;
                             this.port.postMessage({ type: 'ready', sampleRate });
                             console.log('[LUFS Worklet] Initialized with WASM, sampleRate:', sampleRate);
@@ -78,7 +102,10 @@ class LufsMeterProcessor extends AudioWorkletProcessor {
                     break;
                 case 'reset-all':
                     // 切换曲目时调用：清除历史数据（滤波器状态、缓冲区、峰值）
+                    // 同时丢弃暂存区中上一曲目残留的未处理采样
                     if (this._meter) this._meter.reset_all();
+                    this._stagedFrames = 0;
+                    this._stagedQuanta = 0;
                     break;
                 case 'ping':
                     // 健康检查
@@ -113,13 +140,30 @@ class LufsMeterProcessor extends AudioWorkletProcessor {
         // 单声道时，左右声道使用相同数据（LUFS 计算仍正确）
         const rightChannel = inputBus.length > 1 ? inputBus[1] : inputBus[0];
 
-        // 将帧数据送入 WASM 处理器
-        // wasm-bindgen 会自动将 Float32Array 复制到 WASM 线性内存
-        const hasUpdate = this._meter.process_block(leftChannel, rightChannel);
+        let hasUpdate;
+        if (this._stagingCapacity > 0) {
+            // 暂存模式：直接写入 wasm 线性内存，每 drainQuanta 个量子跨一次 FFI
+            this._refreshStagingViews();
+            if (this._stagedFrames + leftChannel.length > this._stagingCapacity) {
+                // 容量将满：先排空
+                hasUpdate = this._drainStaging() || hasUpdate;
+            }
+            this._viewL.set(leftChannel, this._stagedFrames);
+            this._viewR.set(rightChannel, this._stagedFrames);
+            this._stagedFrames += leftChannel.length;
+            this._stagedQuanta += 1;
+
+            if (this._stagedQuanta >= this._drainQuanta) {
+                hasUpdate = this._drainStaging() || hasUpdate;
+            }
+        } else {
+            // 回退模式：逐量子经 wasm-bindgen 复制切片
+            hasUpdate = this._meter.process_block(leftChannel, rightChannel);
+        }
 
         if (hasUpdate) {
             // 读取 WASM 计算的最新 LUFS 和峰值
-            this.port.postMessage({
+            const message = {
                 type: 'lufs-update',
                 momentaryLufs:  this._meter.momentary_lufs,   // 瞬时 LUFS（400ms 窗口）
                 shortTermLufs:  this._meter.short_term_lufs,  // 短期 LUFS（3s 窗口）
@@ -130,11 +174,40 @@ class LufsMeterProcessor extends AudioWorkletProcessor {
                 warmupProgress: this._meter.warmup_progress,  // 预热进度 0~1
                 // currentTime 在 AudioWorkletGlobalScope 中可用
                 currentTime,
-            });
+            };
+            // 过采样 True Peak（wasm 构建包含该 API 时附带）
+            if (this._meter.true_peak_l_db !== undefined) {
+                message.truePeakLDb = this._meter.true_peak_l_db; // 左声道 dBTP
+                message.truePeakRDb = this._meter.true_peak_r_db; // 右声道 dBTP
+            }
+            this.port.postMessage(message);
         }
 
         return true; // 返回 true 使处理器保持活跃（不自动销毁）
     }
+
+    /**
+     * 确保暂存区视图指向当前 wasm 内存（内存增长后旧视图会分离）
+     */
+    _refreshStagingViews() {
+        const memory = this._wasm.memory;
+        if (!this._viewL || this._viewL.buffer !== memory.buffer) {
+            this._viewL = new Float32Array(memory.buffer, this._meter.staging_ptr_l(), this._stagingCapacity);
+            this._viewR = new Float32Array(memory.buffer, this._meter.staging_ptr_r(), this._stagingCapacity);
+        }
+    }
+
+    /**
+     * 排空暂存区：一次 FFI 调用处理累积的全部量子
+     * @returns {boolean} 是否有新的 LUFS 值就绪
+     */
+    _drainStaging() {
+        if (this._stagedFrames === 0) return false;
+        const hasUpdate = this._meter.process_staged(this._stagedFrames);
+        this._stagedFrames = 0;
+        this._stagedQuanta = 0;
+        return hasUpdate;
+    }
 }
 
 // 注册处理器名称（与主线程 new AudioWorkletNode(ctx, 'lufs-meter-processor') 对应）
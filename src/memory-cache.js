@@ -0,0 +1,138 @@
+// ============================================================
+// 进程内共享缓存：按命名空间的 TTL + 全局 LRU 内存上限
+// ============================================================
+// server.js 的热点端点（/api/music-info、/api/audio-info、目录列表、
+// /api/cache-info 等）过去对来自多台设备的相同请求重复做 stat /
+// Python 调用 / 目录遍历。这里提供一个统一的进程级缓存：
+//   - 每个命名空间有独立的 TTL 与命中/未命中计数器
+//   - 全局按近似字节数做 LRU 淘汰（利用 Map 的插入顺序）
+// 用法:
+//   const { createMemoryCache } = require('./memory-cache');
+//   const memCache = createMemoryCache({ maxBytes: 256 * 1024 * 1024 });
+//   const infoCache = memCache.namespace('music-info', { ttlSeconds: 300 });
+//   infoCache.set(key, value); infoCache.get(key); infoCache.delete(key);
+
+// 近似估算一个值占用的字节数（缓存的都是 JSON 可序列化对象或字符串）
+function estimateSize(value) {
+    if (value === null || value === undefined) return 8;
+    if (Buffer.isBuffer(value)) return value.length;
+    if (typeof value === 'string') return value.length * 2;
+    if (typeof value === 'number' || typeof value === 'boolean') return 8;
+    try {
+        return JSON.stringify(value).length * 2;
+    } catch (e) {
+        return 1024; // 无法序列化的对象：按固定值记账
+    }
+}
+
+function createMemoryCache(options = {}) {
+    const maxBytes = options.maxBytes || 256 * 1024 * 1024;
+    const entries = new Map(); // 组合键 → { value, size, expiresAt, ns }
+    const namespaces = new Map(); // 命名空间名 → { ttlMs, hits, misses, sets, evictions }
+    let totalBytes = 0;
+
+    const compositeKey = (ns, key) => ns + '\u0000' + key;
+
+    const removeEntry = (fullKey, entry, isEviction) => {
+        entries.delete(fullKey);
+        totalBytes -= entry.size;
+        if (isEviction) {
+            const nsState = namespaces.get(entry.ns);
+            if (nsState) nsState.evictions++;
+        }
+    };
+
+    // 超出内存上限时从最旧的条目开始淘汰（Map 按插入/触达顺序迭代）
+    const evictUntilFits = () => {
+        if (totalBytes <= maxBytes) return;
+        for (const [fullKey, entry] of entries) {
+            removeEntry(fullKey, entry, true);
+            if (totalBytes <= maxBytes) break;
+        }
+    };
+
+    function namespace(name, nsOptions = {}) {
+        let nsState = namespaces.get(name);
+        if (!nsState) {
+            nsState = {
+                ttlMs: (nsOptions.ttlSeconds || 60) * 1000,
+                hits: 0,
+                misses: 0,
+                sets: 0,
+                evictions: 0
+            };
+            namespaces.set(name, nsState);
+        }
+
+        return {
+            get(key) {
+                const fullKey = compositeKey(name, key);
+                const entry = entries.get(fullKey);
+                if (!entry) {
+                    nsState.misses++;
+                    return undefined;
+                }
+                if (Date.now() > entry.expiresAt) {
+                    removeEntry(fullKey, entry, false);
+                    nsState.misses++;
+                    return undefined;
+                }
+                // LRU 触达：移到 Map 末尾
+                entries.delete(fullKey);
+                entries.set(fullKey, entry);
+                nsState.hits++;
+                return entry.value;
+            },
+            set(key, value) {
+                const fullKey = compositeKey(name, key);
+                const old = entries.get(fullKey);
+                if (old) removeEntry(fullKey, old, false);
+                const size = estimateSize(value);
+                if (size > maxBytes) return; // 单条超过上限：不缓存
+                entries.set(fullKey, {
+                    value,
+                    size,
+                    expiresAt: Date.now() + nsState.ttlMs,
+                    ns: name
+                });
+                totalBytes += size;
+                nsState.sets++;
+                evictUntilFits();
+            },
+            delete(key) {
+                const fullKey = compositeKey(name, key);
+                const entry = entries.get(fullKey);
+                if (entry) removeEntry(fullKey, entry, false);
+            }
+        };
+    }
+
+    function stats() {
+        const perNamespace = {};
+        for (const [name, nsState] of namespaces) {
+            const { hits, misses, sets, evictions } = nsState;
+            perNamespace[name] = {
+                hits,
+                misses,
+                sets,
+                evictions,
+                hitRate: (hits + misses) > 0 ? hits / (hits + misses) : 0
+            };
+        }
+        return {
+            totalBytes,
+            maxBytes,
+            entryCount: entries.size,
+            namespaces: perNamespace
+        };
+    }
+
+    function clear() {
+        entries.clear();
+        totalBytes = 0;
+    }
+
+    return { namespace, stats, clear };
+}
+
+module.exports = { createMemoryCache, estimateSize };
@@ -0,0 +1,132 @@
+/**
+ * music-analyzer-processor.js — AudioWorklet 处理器（可视化分析）
+ *
+ * 职责：
+ *   1. 接收主线程发来的 WASM ArrayBuffer 与 SharedArrayBuffer
+ *   2. 把音频帧（降混为单声道）喂给 wasm MusicAnalyzer
+ *   3. 每个分析帧（hop）把结果从 wasm 内存整块复制进 SharedArrayBuffer，
+ *      渲染循环直接读取预计算值，主线程零计算、零消息开销
+ *
+ * SharedArrayBuffer 布局（Float32Array 视图）：
+ *   [0]  帧计数器（每个新分析帧 +1，主线程用于检测更新）
+ *   [1]  rms
+ *   [2]  spectral_flux（归一化）
+ *   [3]  beat_intensity（节拍包络 0~1）
+ *   [4]  onset（1.0 / 0.0）
+ *   [5..5+bandCount] 平滑频带能量（0~1，对数间隔）
+ *
+ * 初始化流程与 lufs-meter-processor.js 相同：主线程加载 wasm 字节码
+ * 并 postMessage({ type: 'init-wasm', wasmBuffer, sab })。
+ */
+
+// 命名空间导入：旧版 wasm 构建里 MusicAnalyzer 还不存在，具名导入会让
+// 整个模块链接失败、audioWorklet.addModule() 直接 reject；命名空间导入
+// 总能链接成功，缺失的导出留到运行时守卫去报错。
+import * as wasmBindings from '/audio_processor/pkg/audio_processor.js';
+
+const { initSync } = wasmBindings;
+
+// 默认分析参数（可经 processorOptions 覆盖）
+const DEFAULT_FFT_SIZE = 1024;
+const DEFAULT_BAND_COUNT = 24;
+
+class MusicAnalyzerProcessor extends AudioWorkletProcessor {
+    constructor(options) {
+        super();
+
+        this._analyzer = null;
+        this._ready = false;
+        this._wasm = null;
+
+        this._fftSize = options?.processorOptions?.fftSize ?? DEFAULT_FFT_SIZE;
+        this._bandCount = options?.processorOptions?.bandCount ?? DEFAULT_BAND_COUNT;
+
+        this._sabView = null;       // SharedArrayBuffer 上的 Float32Array
+        this._resultsView = null;   // wasm 内存上的结果视图
+        this._resultsLen = 0;
+        this._monoBuffer = new Float32Array(128);
+        this._frameCounter = 0;
+
+        this.port.onmessage = (event) => {
+            const { type, wasmBuffer, sab } = event.data;
+            switch (type) {
+                case 'init-wasm':
+                    try {
+                        if (wasmBuffer) {
+                            this._wasm = initSync({ module: wasmBuffer });
+                        }
+                        if (typeof wasmBindings.MusicAnalyzer !== 'function') {
+                            throw new Error('MusicAnalyzer not exported by wasm build (re-run src/audio_processor/build-wasm.sh and commit pkg/)');
+                        }
+                        this._analyzer = new wasmBindings.MusicAnalyzer(sampleRate, this._fftSize, this._bandCount);
+                        this._resultsLen = this._analyzer.results_len();
+                        if (sab) {
+                            this._sabView = new Float32Array(sab);
+                        }
+                        this._ready = true;
+                        this.port.postMessage({ type: 'ready', sampleRate, resultsLen: this._resultsLen });
+                        console.log('[Analyzer Worklet] Initialized, fftSize:', this._fftSize, 'bands:', this._bandCount);
+                    } catch (e) {
+                        console.error('[Analyzer Worklet] Failed to init:', e);
+                        this.port.postMessage({ type: 'error', message: e.message });
+                    }
+                    break;
+                case 'reset':
+                    // 切换曲目：清除分析历史与节拍状态
+                    if (this._analyzer) this._analyzer.reset();
+                    this._frameCounter = 0;
+                    if (this._sabView) this._sabView.fill(0);
+                    break;
+            }
+        };
+    }
+
+    /**
+     * 确保结果视图指向当前 wasm 内存（内存增长后旧视图会分离）
+     */
+    _refreshResultsView() {
+        const memory = this._wasm?.memory;
+        if (!memory) return;
+        if (!this._resultsView || this._resultsView.buffer !== memory.buffer) {
+            this._resultsView = new Float32Array(memory.buffer, this._analyzer.results_ptr(), this._resultsLen);
+        }
+    }
+
+    process(inputs, _outputs, _parameters) {
+        if (!this._ready || !this._analyzer) return true;
+
+        const inputBus = inputs[0];
+        if (!inputBus || inputBus.length === 0) return true;
+        const left = inputBus[0];
+        if (!left || left.length === 0) return true;
+
+        // 降混为单声道（可视化分析无需声道分离）
+        let mono = left;
+        if (inputBus.length > 1) {
+            const right = inputBus[1];
+            if (this._monoBuffer.length !== left.length) {
+                this._monoBuffer = new Float32Array(left.length);
+            }
+            for (let i = 0; i < left.length; i++) {
+                this._monoBuffer[i] = (left[i] + right[i]) * 0.5;
+            }
+            mono = this._monoBuffer;
+        }
+
+        const hasNewFrame = this._analyzer.process_block(mono);
+
+        if (hasNewFrame && this._sabView) {
+            // 从 wasm 内存整块复制到 SharedArrayBuffer（几十个 f32，开销可忽略）
+            this._refreshResultsView();
+            if (this._resultsView) {
+                this._sabView.set(this._resultsView, 1);
+                this._frameCounter += 1;
+                this._sabView[0] = this._frameCounter;
+            }
+        }
+
+        return true;
+    }
+}
+
+registerProcessor('music-analyzer-processor', MusicAnalyzerProcessor);
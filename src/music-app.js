@@ -520,6 +520,9 @@ document.addEventListener('DOMContentLoaded', () => {
     let analyserMixed = null;   // 高精度混合频谱分析仪（8192 FFT，用于频谱/瀑布图）
     let channelSplitter = null; // 声道分离器（将立体声拆为左右两路）
     let lufsNode = null;        // LUFS 计量 AudioWorklet 节点
+    let musicAnalyzerNode = null;   // wasm 可视化分析 AudioWorklet 节点
+    let wasmAnalysisView = null;    // SharedArrayBuffer 上的分析结果视图
+    const WASM_ANALYZER_BANDS = 120; // 与 SPECTROGRAM_BINS 一致：SAB 频带直接作为 3D 频谱的一行
     let visualizerCtx;
     let mixedFreqFloatData = null;
     let mixedFreqByteData = null;
@@ -638,6 +641,16 @@ document.addEventListener('DOMContentLoaded', () => {
         };
     }
 
+    /**
+     * 读取 wasm 分析帧（SharedArrayBuffer 中的预计算值）
+     * 布局: [0]=帧计数, [1]=rms, [2]=flux, [3]=beat, [4]=onset, [5..]=频带能量
+     * @returns {Float32Array|null} 不可用或尚无数据时返回 null
+     */
+    function getWasmAnalysis() {
+        if (!wasmAnalysisView || wasmAnalysisView[0] === 0) return null;
+        return wasmAnalysisView;
+    }
+
     function ensureVisualizerBuffers() {
         if (analyserMixed) {
             const mixedLen = analyserMixed.frequencyBinCount;
@@ -1322,26 +1335,40 @@ document.addEventListener('DOMContentLoaded', () => {
 
         if (!analyserMixed || !mixedFreqByteData) return;
 
-        analyserMixed.getByteFrequencyData(mixedFreqByteData);
-
+        // wasm 预计算路径：SAB 中的 120 个平滑对数频带直接作为频谱行，
+        // 主线程不再做 getByteFrequencyData + 逐 bin 对数重映射
+        const wasmAnalysis = getWasmAnalysis();
         const frame = new Uint8Array(SPECTROGRAM_BINS);
-        const len = mixedFreqByteData.length;
-        const nyquist = audioContext ? audioContext.sampleRate / 2 : 22050;
-        for (let i = 0; i < SPECTROGRAM_BINS; i++) {
-            const t = i / Math.max(1, SPECTROGRAM_BINS - 1);
-            const freq = 20 * Math.pow(nyquist / 20, t);
-            const idx = clamp(Math.round(freq / nyquist * (len - 1)), 0, len - 1);
-            frame[i] = mixedFreqByteData[idx];
+        if (wasmAnalysis) {
+            for (let i = 0; i < SPECTROGRAM_BINS; i++) {
+                frame[i] = Math.min(255, Math.round((wasmAnalysis[5 + i] || 0) * 255));
+            }
+        } else {
+            // 回退：wasm 分析不可用（无 SAB / 旧构建）时的原主线程路径
+            analyserMixed.getByteFrequencyData(mixedFreqByteData);
+            const len = mixedFreqByteData.length;
+            const nyquist = audioContext ? audioContext.sampleRate / 2 : 22050;
+            for (let i = 0; i < SPECTROGRAM_BINS; i++) {
+                const t = i / Math.max(1, SPECTROGRAM_BINS - 1);
+                const freq = 20 * Math.pow(nyquist / 20, t);
+                const idx = clamp(Math.round(freq / nyquist * (len - 1)), 0, len - 1);
+                frame[i] = mixedFreqByteData[idx];
+            }
         }
         spectrogramHistory.unshift(frame);
         if (spectrogramHistory.length > SPECTROGRAM_HISTORY_SIZE) {
             spectrogramHistory.length = SPECTROGRAM_HISTORY_SIZE;
         }
 
-        // 同步主题色到 WebGL
+        // 同步主题色到 WebGL；节拍包络实时提升亮度（读 SAB 预计算值，无主线程计算）
         if (webglUniforms) {
             const accent = parseAccentColor();
-            webglUniforms.u_color.value.set(accent.r / 255, accent.g / 255, accent.b / 255);
+            const beatBoost = wasmAnalysis ? 1 + wasmAnalysis[3] * 0.35 : 1;
+            webglUniforms.u_color.value.set(
+                Math.min(1, accent.r / 255 * beatBoost),
+                Math.min(1, accent.g / 255 * beatBoost),
+                Math.min(1, accent.b / 255 * beatBoost)
+            );
         }
 
         // 将数据推送给 GPU
@@ -2184,6 +2211,54 @@ document.addEventListener('DOMContentLoaded', () => {
                 lufsNode = null;
             }
 
+            // --- wasm 可视化分析 Worklet：FFT/频带能量/谱通量/节拍在音频线程算好，
+            //     结果经 SharedArrayBuffer 共享，渲染循环只读预计算值 ---
+            try {
+                if (typeof SharedArrayBuffer === 'undefined') {
+                    // 需要 COOP/COEP 响应头（server.js 已设置）才能使用 SAB
+                    console.warn('[Analyzer Worklet] SharedArrayBuffer unavailable, falling back to main-thread analysis');
+                } else {
+                    await audioContext.audioWorklet.addModule('/music-analyzer-processor.js');
+
+                    let analyzerWasmBuffer = null;
+                    try {
+                        const wasmResp = await fetch('/audio_processor/pkg/audio_processor_bg.wasm');
+                        analyzerWasmBuffer = await wasmResp.arrayBuffer();
+                    } catch (e) {
+                        console.warn('[Analyzer Worklet] Failed to preload WASM:', e);
+                    }
+
+                    musicAnalyzerNode = new AudioWorkletNode(audioContext, 'music-analyzer-processor', {
+                        // 2048 点 FFT：低频段有足够 bin 供 120 个对数频带取值
+                        processorOptions: { fftSize: 2048, bandCount: WASM_ANALYZER_BANDS }
+                    });
+
+                    // SAB 布局: [0]=帧计数, [1]=rms, [2]=flux, [3]=beat, [4]=onset, [5..]=频带
+                    const sab = new SharedArrayBuffer((5 + WASM_ANALYZER_BANDS) * 4);
+                    wasmAnalysisView = new Float32Array(sab);
+
+                    try {
+                        musicAnalyzerNode.port.postMessage({ type: 'init-wasm', wasmBuffer: analyzerWasmBuffer, sab }, analyzerWasmBuffer ? [analyzerWasmBuffer] : []);
+                    } catch (e) {
+                        musicAnalyzerNode.port.postMessage({ type: 'init-wasm', wasmBuffer: analyzerWasmBuffer, sab });
+                    }
+
+                    musicAnalyzerNode.port.onmessage = (event) => {
+                        if (event.data.type === 'ready') {
+                            console.log('[Analyzer Worklet] Ready, results length:', event.data.resultsLen);
+                        } else if (event.data.type === 'error') {
+                            console.warn('[Analyzer Worklet] Disabled:', event.data.message);
+                            musicAnalyzerNode = null;
+                            wasmAnalysisView = null;
+                        }
+                    };
+                }
+            } catch (e) {
+                console.warn('[Analyzer Worklet] Failed to load, wasm analysis disabled:', e);
+                musicAnalyzerNode = null;
+                wasmAnalysisView = null;
+            }
+
             // --- 如果在节点初始化之前已从后端拿到 LUFS，则立即应用 ---
             if (typeof currentTrackLufs === 'number') {
                 try {
@@ -2231,6 +2306,10 @@ document.addEventListener('DOMContentLoaded', () => {
         if (lufsNode) {
             try { lufsNode.port.postMessage({ type: 'reset-all' }); } catch (e) { }
         }
+        // 换曲时重置 wasm 可视化分析历史（节拍状态、谱通量基线）
+        if (musicAnalyzerNode) {
+            try { musicAnalyzerNode.port.postMessage({ type: 'reset' }); } catch (e) { }
+        }
         albumCover.classList.remove('playing');
 
         // 验证 index 是否有效
@@ -2290,6 +2369,8 @@ document.addEventListener('DOMContentLoaded', () => {
 
                         // Re-initialize the playlist UI and reload the song from the new context
                         initPlaylist();
+                        // 后台批量回填缓存中的元数据(一次请求,不阻塞播放)
+                        batchFetchPlaylistInfo(playlist);
                         // Call loadSong again, but this time with fromFolderLoad=true to prevent an infinite loop
                         loadSong(currentSongIndex, true, true);
                         // 更新按钮可见性，确保内容加载后正常显示
@@ -2711,6 +2792,99 @@ document.addEventListener('DOMContentLoaded', () => {
         }
     }
 
+    /**
+     * 批量获取播放列表元数据(一次请求解决整个文件夹播放列表)
+     * 通过 /api/music-info/batch 的 NDJSON 流回填缓存命中的标题/艺术家/专辑,
+     * 避免逐曲目请求 /api/music-info 导致加载时间随列表长度线性增长。
+     */
+    async function batchFetchPlaylistInfo(targetPlaylist) {
+        try {
+            // 收集各曲目的相对路径(与 fetchMusicInfo 相同的解析方式)
+            const songsByPath = new Map();
+            let mediaDir = null;
+            for (const song of targetPlaylist) {
+                if (song.userModified) continue;
+                const url = new URL(song.src, window.location.origin);
+                mediaDir = mediaDir || url.searchParams.get('mediaDir');
+                let musicPath = decodeURIComponent(url.pathname);
+                if (musicPath.startsWith('/music/')) {
+                    musicPath = musicPath.substring('/music/'.length);
+                } else if (musicPath.startsWith('/')) {
+                    musicPath = musicPath.substring(1);
+                }
+                songsByPath.set(musicPath, song);
+            }
+            if (songsByPath.size === 0) return;
+
+            const response = await fetch('/api/music-info/batch', {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({
+                    paths: Array.from(songsByPath.keys()),
+                    mediaDir: mediaDir,
+                    // 只回填缓存命中;未入库的曲目仍然在播放时按需解析
+                    resolveMisses: false
+                })
+            });
+            if (!response.ok || !response.body) return;
+
+            const reader = response.body.getReader();
+            const decoder = new TextDecoder();
+            let buffer = '';
+            let updated = false;
+
+            const applyLine = (line) => {
+                let msg;
+                try {
+                    msg = JSON.parse(line);
+                } catch (e) {
+                    return;
+                }
+                if ((msg.type === 'cached' || msg.type === 'resolved') && msg.success && msg.data) {
+                    const song = songsByPath.get(msg.path);
+                    if (!song || song.userModified) return;
+                    const info = msg.data;
+                    if (song.titleFromFilename) {
+                        // 标题来自文件名解析,用缓存中的真实元数据覆盖
+                        if (info.title) { song.title = info.title; updated = true; }
+                        if (info.artist) { song.artist = info.artist; updated = true; }
+                        if (info.album) { song.album = info.album; updated = true; }
+                        if (info.title || info.artist || info.album) {
+                            song.titleFromFilename = false;
+                        }
+                    } else {
+                        // 已有正规元数据,只补全空字段
+                        if (!song.title && info.title) { song.title = info.title; updated = true; }
+                        if (!song.artist && info.artist) { song.artist = info.artist; updated = true; }
+                        if (!song.album && info.album) { song.album = info.album; updated = true; }
+                    }
+                } else if (msg.type === 'done') {
+                    console.log(`[batch-info] Playlist metadata resolved: ${msg.cached}/${msg.total} from cache`);
+                }
+            };
+
+            while (true) {
+                const { done, value } = await reader.read();
+                if (done) break;
+                buffer += decoder.decode(value, { stream: true });
+                let newlineIdx;
+                while ((newlineIdx = buffer.indexOf('\n')) !== -1) {
+                    const line = buffer.slice(0, newlineIdx).trim();
+                    buffer = buffer.slice(newlineIdx + 1);
+                    if (line) applyLine(line);
+                }
+            }
+
+            if (updated) {
+                initPlaylist();
+                updatePlaylistUI();
+                localStorage.setItem('musicPlaylist', JSON.stringify(playlist));
+            }
+        } catch (error) {
+            console.error('Error batch fetching playlist info:', error);
+        }
+    }
+
     /**
      * 尝试加载本地字幕(用于非音乐文件)
      * 当判断为"非音乐"时自动查找并加载合适的本地字幕
@@ -3108,6 +3282,11 @@ document.addEventListener('DOMContentLoaded', () => {
                     normCompressorNode.connect(lufsNode);
                 }
 
+                // wasm 可视化分析节点（终端节点，不产生输出）
+                if (musicAnalyzerNode) {
+                    normCompressorNode.connect(musicAnalyzerNode);
+                }
+
                 // 4. 最终输出到扬声器
                 normCompressorNode.connect(Howler.ctx.destination);
 
@@ -0,0 +1,133 @@
+// ============================================================
+// 轻量性能指标：每端点请求计数/延迟直方图 + 子进程统计
+// ============================================================
+// 诊断"服务器变慢"不再依赖散落的 console.log：
+//   - 每个端点的请求数、累计耗时与固定桶直方图
+//   - 每类子进程（ffmpeg / ffprobe / 各 python 脚本）的启动次数、
+//     累计时长与当前并发 gauge
+// 一切都是纯内存自增，空闲时零开销。由 /api/perf 以 JSON 或
+// Prometheus 文本格式暴露。
+// 用法:
+//   const { createPerfMetrics } = require('./perf-metrics');
+//   const perf = createPerfMetrics();
+//   perf.recordRequest('/api/music-info', 12.3);
+//   const end = perf.spawnStarted('ffmpeg'); ... end();
+
+// 延迟直方图桶上界（毫秒）
+const LATENCY_BUCKETS_MS = [5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000];
+
+function createPerfMetrics() {
+    const startedAt = Date.now();
+    const requests = new Map(); // endpoint → { count, totalMs, maxMs, buckets[], overflow }
+    const spawns = new Map();   // 命令标签 → { count, active, totalMs, failures }
+
+    function recordRequest(endpoint, durationMs) {
+        let entry = requests.get(endpoint);
+        if (!entry) {
+            entry = { count: 0, totalMs: 0, maxMs: 0, buckets: new Array(LATENCY_BUCKETS_MS.length).fill(0), overflow: 0 };
+            requests.set(endpoint, entry);
+        }
+        entry.count++;
+        entry.totalMs += durationMs;
+        if (durationMs > entry.maxMs) entry.maxMs = durationMs;
+        let placed = false;
+        for (let i = 0; i < LATENCY_BUCKETS_MS.length; i++) {
+            if (durationMs <= LATENCY_BUCKETS_MS[i]) {
+                entry.buckets[i]++;
+                placed = true;
+                break;
+            }
+        }
+        if (!placed) entry.overflow++;
+    }
+
+    // 返回一个结束函数：end(exitCode) 记录时长与失败计数并递减并发 gauge
+    function spawnStarted(label) {
+        let entry = spawns.get(label);
+        if (!entry) {
+            entry = { count: 0, active: 0, totalMs: 0, failures: 0 };
+            spawns.set(label, entry);
+        }
+        entry.count++;
+        entry.active++;
+        const start = Date.now();
+        let ended = false;
+        return (exitCode) => {
+            if (ended) return; // close 与 error 可能都触发
+            ended = true;
+            entry.active--;
+            entry.totalMs += Date.now() - start;
+            if (exitCode !== 0 && exitCode !== undefined && exitCode !== null) {
+                entry.failures++;
+            }
+        };
+    }
+
+    function snapshot(extra = {}) {
+        const requestStats = {};
+        for (const [endpoint, e] of requests) {
+            requestStats[endpoint] = {
+                count: e.count,
+                avg_ms: e.count > 0 ? +(e.totalMs / e.count).toFixed(2) : 0,
+                max_ms: +e.maxMs.toFixed(2),
+                histogram: Object.fromEntries(LATENCY_BUCKETS_MS.map((le, i) => [`le_${le}ms`, e.buckets[i]])),
+                overflow: e.overflow
+            };
+        }
+        const spawnStats = {};
+        for (const [label, s] of spawns) {
+            spawnStats[label] = {
+                count: s.count,
+                active: s.active,
+                avg_ms: s.count - s.active > 0 ? +(s.totalMs / (s.count - s.active)).toFixed(1) : 0,
+                failures: s.failures
+            };
+        }
+        return {
+            uptime_seconds: Math.floor((Date.now() - startedAt) / 1000),
+            requests: requestStats,
+            spawns: spawnStats,
+            ...extra
+        };
+    }
+
+    // Prometheus 文本格式（零依赖的手写 exposition）
+    function toPrometheus(extra = {}) {
+        const lines = [];
+        const esc = (s) => String(s).replace(/"/g, '\\"');
+        lines.push('# TYPE webplayer_requests_total counter');
+        lines.push('# TYPE webplayer_request_duration_ms histogram');
+        for (const [endpoint, e] of requests) {
+            const label = `endpoint="${esc(endpoint)}"`;
+            lines.push(`webplayer_requests_total{${label}} ${e.count}`);
+            let cumulative = 0;
+            for (let i = 0; i < LATENCY_BUCKETS_MS.length; i++) {
+                cumulative += e.buckets[i];
+                lines.push(`webplayer_request_duration_ms_bucket{${label},le="${LATENCY_BUCKETS_MS[i]}"} ${cumulative}`);
+            }
+            lines.push(`webplayer_request_duration_ms_bucket{${label},le="+Inf"} ${cumulative + e.overflow}`);
+            lines.push(`webplayer_request_duration_ms_sum{${label}} ${e.totalMs.toFixed(2)}`);
+            lines.push(`webplayer_request_duration_ms_count{${label}} ${e.count}`);
+        }
+        lines.push('# TYPE webplayer_spawns_total counter');
+        lines.push('# TYPE webplayer_spawns_active gauge');
+        for (const [label, s] of spawns) {
+            const l = `command="${esc(label)}"`;
+            lines.push(`webplayer_spawns_total{${l}} ${s.count}`);
+            lines.push(`webplayer_spawns_active{${l}} ${s.active}`);
+            lines.push(`webplayer_spawn_duration_ms_sum{${l}} ${s.totalMs}`);
+            lines.push(`webplayer_spawn_failures_total{${l}} ${s.failures}`);
+        }
+        for (const [key, value] of Object.entries(extra)) {
+            if (typeof value === 'number') {
+                lines.push(`# TYPE webplayer_${key} gauge`);
+                lines.push(`webplayer_${key} ${value}`);
+            }
+        }
+        return lines.join('\n') + '\n';
+    }
+
+    return { recordRequest, spawnStarted, snapshot, toPrometheus };
+}
+
+module.exports = { createPerfMetrics, LATENCY_BUCKETS_MS };
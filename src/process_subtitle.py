@@ -11,6 +11,7 @@ import re
 import os
 import json
 import time
+import copy
 import torch
 from transformers import AutoTokenizer, AutoModelForCausalLM
 import webvtt
@@ -140,6 +141,16 @@ class VTTCorrector:
         # 取消标志
         self.cancel_flag = None
 
+        # 跨任务共享的推理调度器（由 subtitle_process_backend 注入；
+        # 设置后本地模型推理经由调度器排队/合批，而不是各任务直接调用模型）
+        self.inference_scheduler = None
+
+        # 静态前缀 KV 缓存（Transformers 路径）：指令+术语表前缀只前向一次。
+        # 记录最近若干个前缀，并发任务各有术语表时互不挤掉对方
+        self._known_static_prefixes = []
+        self._prefix_cache = None
+        self._prefix_cache_key = None
+
         # 设置生成参数
         self.generation_config = {
             "max_new_tokens": 512,
@@ -526,6 +537,16 @@ class VTTCorrector:
             )
             self.tokenizer = None  # llama-cpp-python 内置分词
 
+            # 提示前缀缓存：同一文件的指令+术语表前缀只评估一次，
+            # 后续各组字幕只评估新增的后缀（llama.cpp 按最长公共前缀复用状态）
+            try:
+                from llama_cpp import LlamaRAMCache
+                cache_mb = gguf_config.get("prompt_cache_mb", 512)
+                self.model.set_cache(LlamaRAMCache(capacity_bytes=cache_mb * 1024 * 1024))
+                logger.info(f"已启用 llama.cpp 提示前缀缓存 ({cache_mb}MB)。")
+            except Exception as e:
+                logger.warning(f"启用 llama.cpp 提示缓存失败（将退回逐次完整评估）: {e}")
+
             # 更新生成配置
             gen_config = self.model_config.get("generation_config", {})
             self.generation_config.update(gen_config)
@@ -641,8 +662,12 @@ class VTTCorrector:
 纠正后的文本："""
         )
         
+        # 记录静态前缀（{context} 之前的指令部分），供本地模型的 KV 前缀缓存复用
+        if "{context}" in correction_prompt_template:
+            self._remember_static_prefix(correction_prompt_template.split("{context}", 1)[0])
+
         prompt = correction_prompt_template.format(context=context)
-        
+
         return prompt
     
     def _create_chat_prompt(self, query: str, history: List[dict] = None, context: Optional[dict] = None) -> List[dict]:
@@ -849,35 +874,80 @@ class VTTCorrector:
                 )
                 return completion.choices[0].message.content.strip()
 
-            if self.model_format == 'gguf':
-                completion = self.model.create_chat_completion(
-                    messages,
-                    temperature=0.5,
-                    max_tokens=1024,
-                )
-                return completion['choices'][0]['message']['content']
-            
-            # Transformers
-            text = self.tokenizer.apply_chat_template(messages, tokenize=False, add_generation_prompt=True)
-            model_inputs = self.tokenizer([text], return_tensors="pt").to(self.device)
-            
-            gen_config = self.generation_config.copy()
-            gen_config["temperature"] = 0.5
-            
-            with torch.no_grad():
-                generated_ids = self.model.generate(model_inputs.input_ids, **gen_config)
-            
-            generated_ids = [
-                output_ids[len(input_ids):]
-                for input_ids, output_ids in zip(model_inputs.input_ids, generated_ids)
-            ]
-            response = self.tokenizer.batch_decode(generated_ids, skip_special_tokens=True)[0]
-            return response.strip()
+            # 本地模型：有共享调度器时必须经调度器排队/合批执行——
+            # llama.cpp 上下文不允许两个线程并发调用（术语表任务与
+            # 正在进行的翻译任务会撞在一起），调度器同时提供跨任务合批
+            if self.inference_scheduler is not None:
+                return self.inference_scheduler.generate_raw(self, prompt, system_prompt)
+            return self._generate_local_raw(prompt, system_prompt)
 
         except Exception as e:
             logger.error(f"执行原始提示时出错: {e}")
             return ""
 
+    def _generate_local_raw(self, prompt: str, system_prompt: Optional[str] = None) -> str:
+        """原始提示词的本地模型单条推理（调度器的 GGUF 单流路径也走这里）。"""
+        messages = []
+        if system_prompt:
+            messages.append({"role": "system", "content": system_prompt})
+        messages.append({"role": "user", "content": prompt})
+
+        if self.model_format == 'gguf':
+            completion = self.model.create_chat_completion(
+                messages,
+                temperature=0.5,
+                max_tokens=1024,
+            )
+            return completion['choices'][0]['message']['content']
+
+        # Transformers
+        text = self.tokenizer.apply_chat_template(messages, tokenize=False, add_generation_prompt=True)
+        model_inputs = self.tokenizer([text], return_tensors="pt").to(self.device)
+
+        gen_config = self.generation_config.copy()
+        gen_config["temperature"] = 0.5
+
+        with torch.no_grad():
+            generated_ids = self.model.generate(model_inputs.input_ids, **gen_config)
+
+        generated_ids = [
+            output_ids[len(input_ids):]
+            for input_ids, output_ids in zip(model_inputs.input_ids, generated_ids)
+        ]
+        response = self.tokenizer.batch_decode(generated_ids, skip_special_tokens=True)[0]
+        return response.strip()
+
+    def _generate_local_raw_transformers_batch(self, prompts: List[str], system_prompt: Optional[str] = None) -> List[str]:
+        """原始提示词的 Transformers 合批推理（同一 system_prompt 的多条提示）。"""
+        texts = []
+        for prompt in prompts:
+            messages = []
+            if system_prompt:
+                messages.append({"role": "system", "content": system_prompt})
+            messages.append({"role": "user", "content": prompt})
+            texts.append(self.tokenizer.apply_chat_template(messages, tokenize=False, add_generation_prompt=True))
+
+        gen_config = self.generation_config.copy()
+        gen_config["temperature"] = 0.5
+
+        original_padding_side = self.tokenizer.padding_side
+        if self.tokenizer.pad_token is None:
+            self.tokenizer.pad_token = self.tokenizer.eos_token
+        self.tokenizer.padding_side = 'left'
+        try:
+            model_inputs = self.tokenizer(texts, return_tensors="pt", padding=True).to(self.device)
+        finally:
+            self.tokenizer.padding_side = original_padding_side
+
+        with torch.no_grad():
+            generated_ids = self.model.generate(
+                model_inputs.input_ids,
+                attention_mask=model_inputs.attention_mask,
+                **gen_config
+            )
+        output_ids = generated_ids[:, model_inputs.input_ids.shape[1]:]
+        return [r.strip() for r in self.tokenizer.batch_decode(output_ids, skip_special_tokens=True)]
+
     @retry(
         stop=stop_after_attempt(3),
         wait=wait_exponential(multiplier=1, min=1, max=10),
@@ -947,7 +1017,14 @@ class VTTCorrector:
         max_tokens = gen_config.get("max_new_tokens")
         if max_tokens:
             api_params["max_tokens"] = max_tokens
-        
+
+        # 提供商提示缓存：system 消息（指令+术语表）在请求间保持字节一致，
+        # OpenAI/DeepSeek 等端点会自动命中前缀缓存；需要显式参数的端点
+        # 可在模型配置中提供 prompt_cache_params（原样并入请求体）
+        prompt_cache_params = self.model_config.get("prompt_cache_params")
+        if prompt_cache_params:
+            api_params.update(prompt_cache_params)
+
         completion = self.online_client.chat.completions.create(**api_params)
         response = completion.choices[0].message.content
 
@@ -978,49 +1055,12 @@ class VTTCorrector:
                     logger.error(f"调用在线纠错API时出错 (已重试): {e}")
                     return "\n".join(text_segments)
 
-            if self.model_format == 'gguf':
-                # GGUF模型推理
-                messages = [{"role": "user", "content": prompt}]
-                completion = self.model.create_chat_completion(
-                    messages,
-                    max_tokens=self.generation_config.get("max_new_tokens", 512),
-                    temperature=self.generation_config.get("temperature", 0.1),
-                    top_p=self.generation_config.get("top_p", 0.9),
-                    stop=["<|im_end|>", "</s>"]  # 常用停止符
-                )
-                response = completion['choices'][0]['message']['content']
+            # 本地模型推理：有共享调度器时排队/合批执行，否则直接调用
+            if self.inference_scheduler is not None:
+                response = self.inference_scheduler.generate(self, prompt, is_translation=False)
             else:
-                # Transformers模型推理
-                # 支持两种配置键名: `transformers_config` 或 `transformers`
-                trans_config = self.model_config.get("transformers_config", {}) or self.model_config.get("transformers", {})
-                model_type = trans_config.get("model_type", "auto")
+                response = self._generate_local(prompt, is_translation=False)
 
-                # 尝试应用聊天模板，如果分词器没有配置模板，则会失败
-                try:
-                    if hasattr(self.tokenizer, 'apply_chat_template') and model_type in ["qwen", "auto"] and self.tokenizer.chat_template:
-                        messages = [{"role": "user", "content": prompt}]
-                        text = self.tokenizer.apply_chat_template(messages, tokenize=False, add_generation_prompt=True)
-                        logger.info("已应用聊天模板。")
-                    else:
-                        text = prompt
-                except Exception as e:
-                    logger.warning(f"应用聊天模板失败: {e}. 将回退到原始提示词。")
-                    text = prompt
-                
-                model_inputs = self.tokenizer([text], return_tensors="pt").to(self.device)
-                
-                with torch.no_grad():
-                    generated_ids = self.model.generate(
-                        model_inputs.input_ids,
-                        **self.generation_config
-                    )
-                
-                generated_ids = [
-                    output_ids[len(input_ids):]
-                    for input_ids, output_ids in zip(model_inputs.input_ids, generated_ids)
-                ]
-                response = self.tokenizer.batch_decode(generated_ids, skip_special_tokens=True)[0]
-            
             # 清理响应，只保留纠正后的文本
             corrected_text = self._clean_response(response)
             
@@ -1030,6 +1070,262 @@ class VTTCorrector:
             logger.error(f"文本纠错失败: {e}")
             return "\n".join(text_segments)  # 返回原文本
     
+    TRANSLATION_SYSTEM_PROMPT = "你是一个轻小说翻译模型，可以流畅通顺地以日本轻小说的风格将日文翻译成简体中文，并联系上下文正确使用人称代词，不擅自添加原文中没有的代词。"
+
+    def _format_transformers_prompt(self, prompt: str, is_translation: bool) -> str:
+        """为 Transformers 路径构建格式化输入（单条与合批推理共用）。"""
+        if is_translation:
+            messages = [
+                {"role": "system", "content": self.TRANSLATION_SYSTEM_PROMPT},
+                {"role": "user", "content": prompt}
+            ]
+            return self.tokenizer.apply_chat_template(
+                messages,
+                tokenize=False,
+                add_generation_prompt=True
+            )
+
+        # 纠错路径：支持两种配置键名: `transformers_config` 或 `transformers`
+        trans_config = self.model_config.get("transformers_config", {}) or self.model_config.get("transformers", {})
+        model_type = trans_config.get("model_type", "auto")
+        # 尝试应用聊天模板，如果分词器没有配置模板，则会失败
+        try:
+            if hasattr(self.tokenizer, 'apply_chat_template') and model_type in ["qwen", "auto"] and self.tokenizer.chat_template:
+                messages = [{"role": "user", "content": prompt}]
+                text = self.tokenizer.apply_chat_template(messages, tokenize=False, add_generation_prompt=True)
+                logger.info("已应用聊天模板。")
+                return text
+            return prompt
+        except Exception as e:
+            logger.warning(f"应用聊天模板失败: {e}. 将回退到原始提示词。")
+            return prompt
+
+    def _transformers_gen_config(self, is_translation: bool) -> dict:
+        """Transformers 路径的生成参数（单条与合批推理共用）。"""
+        if not is_translation:
+            return dict(self.generation_config)
+
+        # 按照 SakuraLLM 官方推荐参数设置
+        gen_config = {
+            "temperature": 0.1,
+            "top_p": 0.3,
+            "repetition_penalty": 1.0,
+            "max_new_tokens": 512,
+            "min_new_tokens": 1,
+            "num_beams": 1,
+            "pad_token_id": self.tokenizer.eos_token_id
+        }
+        # 覆盖用户自定义参数（如果有的话）
+        user_gen_config = self.model_config.get("generation_config", {})
+        for key in ["temperature", "top_p", "repetition_penalty", "max_new_tokens"]:
+            if key in user_gen_config:
+                gen_config[key] = user_gen_config[key]
+        return gen_config
+
+    def _generate_local(self, prompt: str, is_translation: bool) -> str:
+        """本地模型单条推理（GGUF 或 Transformers），纠错/翻译共用的底层入口。
+
+        共享推理调度器（subtitle_process_backend.InferenceScheduler）在
+        GGUF 单流路径以及合批失败的回退路径中也调用该方法。
+        """
+        if self.model_format == 'gguf':
+            if is_translation:
+                gguf_config = self.model_config.get("gguf_config", {})
+                use_raw_prompt = gguf_config.get("use_raw_prompt_for_translation", False)
+                gen_config = self.model_config.get("generation_config", {})
+
+                # 按照 SakuraLLM 官方推荐参数设置
+                api_params = {
+                    'temperature': 0.1,
+                    'top_p': 0.3,
+                    'repeat_penalty': 1.0,
+                    'max_tokens': gen_config.get("max_new_tokens", 512)
+                }
+                # 覆盖用户自定义参数（如果有的话）
+                for key in ["temperature", "top_p", "repeat_penalty"]:
+                    if key in gen_config:
+                        api_params[key] = gen_config[key]
+
+                logger.info(f"GGUF翻译参数: {api_params}")
+                logger.info(f"提示词前200字符: {prompt[:200]}")
+
+                if use_raw_prompt:
+                    logger.info("使用原始提示模式进行翻译 (GGUF)。")
+                    # 按照 SakuraLLM v0.9/v1.0 格式构建完整提示词
+                    chat_format = gguf_config.get("chat_format", "")
+                    if chat_format == "llama-2":
+                        full_raw_prompt = f"<s>[INST] <<SYS>>\n{self.TRANSLATION_SYSTEM_PROMPT}\n<</SYS>>\n\n{prompt} [/INST]"
+                    else:
+                        # ChatML 格式（qwen-3/chatml，也是 SakuraLLM 推荐的默认）
+                        full_raw_prompt = f"<|im_start|>system\n{self.TRANSLATION_SYSTEM_PROMPT}<|im_end|>\n<|im_start|>user\n{prompt}<|im_end|>\n<|im_start|>assistant\n"
+
+                    completion = self.model(
+                        prompt=full_raw_prompt,
+                        **api_params
+                    )
+                    response = completion['choices'][0]['text']
+                else:
+                    # 使用聊天模式
+                    messages = [
+                        {"role": "system", "content": self.TRANSLATION_SYSTEM_PROMPT},
+                        {"role": "user", "content": prompt}
+                    ]
+                    completion = self.model.create_chat_completion(
+                        messages,
+                        **api_params
+                    )
+                    response = completion['choices'][0]['message']['content']
+
+                logger.info(f"GGUF原始响应前200字符: {response[:200] if response else '(空响应)'}")
+                return response
+
+            # 纠错路径
+            messages = [{"role": "user", "content": prompt}]
+            completion = self.model.create_chat_completion(
+                messages,
+                max_tokens=self.generation_config.get("max_new_tokens", 512),
+                temperature=self.generation_config.get("temperature", 0.1),
+                top_p=self.generation_config.get("top_p", 0.9),
+                stop=["<|im_end|>", "</s>"]  # 常用停止符
+            )
+            return completion['choices'][0]['message']['content']
+
+        # Transformers 路径
+        formatted_prompt = self._format_transformers_prompt(prompt, is_translation)
+        gen_config = self._transformers_gen_config(is_translation)
+        if is_translation:
+            logger.info(f"Transformers翻译参数: {gen_config}")
+            logger.info(f"格式化提示词前200字符: {formatted_prompt[:200]}")
+
+        # 优先走静态前缀 KV 缓存路径（指令+术语表只前向一次）
+        cached_response = self._generate_transformers_with_prefix_cache(formatted_prompt, gen_config)
+        if cached_response is not None:
+            if is_translation:
+                logger.info(f"Transformers原始响应前200字符: {cached_response[:200] if cached_response else '(空响应)'}")
+            return cached_response
+
+        model_inputs = self.tokenizer([formatted_prompt], return_tensors="pt").to(self.device)
+
+        with torch.no_grad():
+            generated_ids = self.model.generate(
+                model_inputs.input_ids,
+                **gen_config
+            )
+
+        generated_ids = [
+            output_ids[len(input_ids):]
+            for input_ids, output_ids in zip(model_inputs.input_ids, generated_ids)
+        ]
+        response = self.tokenizer.batch_decode(generated_ids, skip_special_tokens=True)[0]
+        if is_translation:
+            logger.info(f"Transformers原始响应前200字符: {response[:200] if response else '(空响应)'}")
+        return response
+
+    def _remember_static_prefix(self, prefix: str):
+        """登记一个静态前缀候选（长度不足的忽略，最多保留最近 4 个）。"""
+        if not prefix or len(prefix) < 200:
+            return
+        if prefix in self._known_static_prefixes:
+            return
+        self._known_static_prefixes.append(prefix)
+        if len(self._known_static_prefixes) > 4:
+            self._known_static_prefixes.pop(0)
+
+    def _generate_transformers_with_prefix_cache(self, formatted_prompt: str, gen_config: dict):
+        """尝试复用静态前缀（指令+术语表）的 KV 缓存，只评估每组新增的后缀。
+
+        2,000 条字幕的文件会把同一个 ~1,500 token 的前缀评估数百次，
+        这里把前缀的前向结果缓存为 DynamicCache，每组只评估字幕文本本身。
+        任何一步不满足（版本、模板结构、前缀过短）都返回 None 回退到完整评估。
+        """
+        # 在已知前缀中找到本提示实际包含的那个（取最长匹配）
+        static_prefix = None
+        cut = -1
+        for candidate in self._known_static_prefixes:
+            pos = formatted_prompt.find(candidate)
+            if pos != -1 and (static_prefix is None or len(candidate) > len(static_prefix)):
+                static_prefix = candidate
+                cut = pos
+        if static_prefix is None:
+            return None
+        prefix_char_end = cut + len(static_prefix)
+
+        try:
+            from transformers import DynamicCache
+        except Exception:
+            return None
+
+        try:
+            full_inputs = self.tokenizer([formatted_prompt], return_tensors="pt").to(self.device)
+            full_ids = full_inputs.input_ids
+            prefix_only_ids = self.tokenizer([formatted_prompt[:prefix_char_end]], return_tensors="pt").input_ids[0]
+
+            # 求字符切分点处的最长公共 token 前缀（切分点可能落在 token 中间）
+            full_list = full_ids[0].tolist()
+            prefix_list = prefix_only_ids.tolist()
+            n = 0
+            while n < len(prefix_list) and n < len(full_list) and prefix_list[n] == full_list[n]:
+                n += 1
+            if n < 32:
+                return None  # 前缀太短，缓存不划算
+
+            cache_key = (id(self.model), tuple(full_list[:n]))
+            if self._prefix_cache_key != cache_key:
+                with torch.no_grad():
+                    prefix_out = self.model(input_ids=full_ids[:, :n], use_cache=True)
+                cache = prefix_out.past_key_values
+                if not isinstance(cache, DynamicCache):
+                    cache = DynamicCache.from_legacy_cache(cache)
+                self._prefix_cache = cache
+                self._prefix_cache_key = cache_key
+                logger.info(f"静态前缀 KV 缓存已建立（{n} tokens）。")
+
+            # generate 会在缓存上追加 token，必须在副本上运行
+            cache_copy = copy.deepcopy(self._prefix_cache)
+            with torch.no_grad():
+                generated_ids = self.model.generate(
+                    full_ids,
+                    attention_mask=full_inputs.attention_mask,
+                    past_key_values=cache_copy,
+                    **gen_config
+                )
+            output_ids = generated_ids[0][full_ids.shape[1]:]
+            return self.tokenizer.decode(output_ids, skip_special_tokens=True)
+        except Exception as e:
+            logger.warning(f"前缀 KV 缓存路径失败，回退到完整评估: {e}")
+            self._prefix_cache = None
+            self._prefix_cache_key = None
+            return None
+
+    def _generate_local_transformers_batch(self, prompts: List[str], is_translation: bool) -> List[str]:
+        """Transformers 路径的合批推理：多个任务的提示一次 generate。
+
+        仅由共享推理调度器调用；所有提示必须来自同一 corrector 且同为
+        翻译或纠错（生成参数一致才能合批）。
+        """
+        texts = [self._format_transformers_prompt(p, is_translation) for p in prompts]
+        gen_config = self._transformers_gen_config(is_translation)
+
+        # 左侧 padding，使输出可以统一按输入长度切片
+        original_padding_side = self.tokenizer.padding_side
+        if self.tokenizer.pad_token is None:
+            self.tokenizer.pad_token = self.tokenizer.eos_token
+        self.tokenizer.padding_side = 'left'
+        try:
+            model_inputs = self.tokenizer(texts, return_tensors="pt", padding=True).to(self.device)
+        finally:
+            self.tokenizer.padding_side = original_padding_side
+
+        with torch.no_grad():
+            generated_ids = self.model.generate(
+                model_inputs.input_ids,
+                attention_mask=model_inputs.attention_mask,
+                **gen_config
+            )
+
+        output_ids = generated_ids[:, model_inputs.input_ids.shape[1]:]
+        return self.tokenizer.batch_decode(output_ids, skip_special_tokens=True)
+
     def _clean_llm_response(self, text: str) -> str:
         """
         Cleans the response from the LLM by removing common artifacts.
@@ -1190,16 +1486,22 @@ class VTTCorrector:
         if self.glossary_content and self.glossary_content.strip() and self.glossary_content != "无":
             glossary_to_insert = self.glossary_content.strip()
 
-        # Replace placeholders in the template
-        prompt = translation_prompt_template.replace("{context}", context)
-        
+        # 先替换术语表占位符，使"指令+术语表"成为稳定的静态前缀
         # The online model config uses "[Glossary]" as a placeholder
-        if "[Glossary]" in prompt:
-            prompt = prompt.replace("[Glossary]", glossary_to_insert)
+        prompt_template = translation_prompt_template
+        if "[Glossary]" in prompt_template:
+            prompt_template = prompt_template.replace("[Glossary]", glossary_to_insert)
         # A different model might use "{glossary}"
-        elif "{glossary}" in prompt:
-            prompt = prompt.replace("{glossary}", glossary_to_insert)
-            
+        elif "{glossary}" in prompt_template:
+            prompt_template = prompt_template.replace("{glossary}", glossary_to_insert)
+
+        # 记录静态前缀（{context} 之前的指令+术语表），供本地模型的 KV 前缀缓存复用
+        if "{context}" in prompt_template:
+            self._remember_static_prefix(prompt_template.split("{context}", 1)[0])
+
+        # Replace placeholders in the template
+        prompt = prompt_template.replace("{context}", context)
+
         return prompt
     
     def _translate_text_batch(self, text_segments: List[str]) -> str:
@@ -1217,116 +1519,12 @@ class VTTCorrector:
                     logger.error(f"调用在线翻译API时出错 (已重试): {e}")
                     return "\n".join(text_segments)
 
-            if self.model_format == 'gguf':
-                gguf_config = self.model_config.get("gguf_config", {})
-                use_raw_prompt = gguf_config.get("use_raw_prompt_for_translation", False)
-                gen_config = self.model_config.get("generation_config", {})
-
-                # 按照 SakuraLLM 官方推荐参数设置
-                api_params = {
-                    'temperature': 0.1,
-                    'top_p': 0.3,
-                    'repeat_penalty': 1.0,
-                    'max_tokens': gen_config.get("max_new_tokens", 512)
-                }
-                
-                # 覆盖用户自定义参数（如果有的话）
-                for key in ["temperature", "top_p", "repeat_penalty"]:
-                    if key in gen_config:
-                        api_params[key] = gen_config[key]
-
-                logger.info(f"GGUF翻译参数: {api_params}")
-                logger.info(f"提示词前200字符: {prompt[:200]}")
-
-                if use_raw_prompt:
-                    logger.info("使用原始提示模式进行翻译 (GGUF)。")
-                    # 按照 SakuraLLM v0.9/v1.0 格式构建完整提示词
-                    chat_format = gguf_config.get("chat_format", "")
-                    
-                    system_prompt = "你是一个轻小说翻译模型，可以流畅通顺地以日本轻小说的风格将日文翻译成简体中文，并联系上下文正确使用人称代词，不擅自添加原文中没有的代词。"
-                    
-                    if chat_format == "llama-2":
-                        full_raw_prompt = f"<s>[INST] <<SYS>>\n{system_prompt}\n<</SYS>>\n\n{prompt} [/INST]"
-                    elif chat_format in ["qwen-3", "chatml"]:
-                        full_raw_prompt = f"<|im_start|>system\n{system_prompt}<|im_end|>\n<|im_start|>user\n{prompt}<|im_end|>\n<|im_start|>assistant\n"
-                    else:
-                        # 默认使用 ChatML 格式（SakuraLLM 推荐）
-                        full_raw_prompt = f"<|im_start|>system\n{system_prompt}<|im_end|>\n<|im_start|>user\n{prompt}<|im_end|>\n<|im_start|>assistant\n"
+            # 本地模型推理：有共享调度器时排队/合批执行，否则直接调用
+            if self.inference_scheduler is not None:
+                response = self.inference_scheduler.generate(self, prompt, is_translation=True)
+            else:
+                response = self._generate_local(prompt, is_translation=True)
 
-                    completion = self.model(
-                        prompt=full_raw_prompt,
-                        **api_params
-                    )
-                    response = completion['choices'][0]['text']
-                else:
-                    # 使用聊天模式
-                    system_prompt = "你是一个轻小说翻译模型，可以流畅通顺地以日本轻小说的风格将日文翻译成简体中文，并联系上下文正确使用人称代词，不擅自添加原文中没有的代词。"
-                    
-                    messages = [
-                        {"role": "system", "content": system_prompt},
-                        {"role": "user", "content": prompt}
-                    ]
-                    
-                    completion = self.model.create_chat_completion(
-                        messages,
-                        **api_params
-                    )
-                    response = completion['choices'][0]['message']['content']
-                    
-                logger.info(f"GGUF原始响应前200字符: {response[:200] if response else '(空响应)'}")
-                
-            else: # Transformers
-                # 为 Transformers 模型创建聊天格式的输入
-                system_prompt = "你是一个轻小说翻译模型，可以流畅通顺地以日本轻小说的风格将日文翻译成简体中文，并联系上下文正确使用人称代词，不擅自添加原文中没有的代词。"
-                
-                messages = [
-                    {"role": "system", "content": system_prompt},
-                    {"role": "user", "content": prompt}
-                ]
-                
-                # 使用聊天模板格式化输入
-                formatted_prompt = self.tokenizer.apply_chat_template(
-                    messages,
-                    tokenize=False,
-                    add_generation_prompt=True
-                )
-                
-                model_inputs = self.tokenizer([formatted_prompt], return_tensors="pt").to(self.device)
-                
-                # 按照 SakuraLLM 官方推荐参数设置
-                gen_config = {
-                    "temperature": 0.1,
-                    "top_p": 0.3,
-                    "repetition_penalty": 1.0,
-                    "max_new_tokens": 512,
-                    "min_new_tokens": 1,
-                    "num_beams": 1,
-                    "pad_token_id": self.tokenizer.eos_token_id
-                }
-                
-                # 覆盖用户自定义参数（如果有的话）
-                user_gen_config = self.model_config.get("generation_config", {})
-                for key in ["temperature", "top_p", "repetition_penalty", "max_new_tokens"]:
-                    if key in user_gen_config:
-                        gen_config[key] = user_gen_config[key]
-                
-                logger.info(f"Transformers翻译参数: {gen_config}")
-                logger.info(f"格式化提示词前200字符: {formatted_prompt[:200]}")
-                
-                with torch.no_grad():
-                    generated_ids = self.model.generate(
-                        model_inputs.input_ids,
-                        **gen_config
-                    )
-                
-                generated_ids = [
-                    output_ids[len(input_ids):]
-                    for input_ids, output_ids in zip(model_inputs.input_ids, generated_ids)
-                ]
-                response = self.tokenizer.batch_decode(generated_ids, skip_special_tokens=True)[0]
-                
-                logger.info(f"Transformers原始响应前200字符: {response[:200] if response else '(空响应)'}")
-            
             # 检查是否有响应
             if not response or not response.strip():
                 logger.error("模型生成了空响应")
@@ -69,6 +69,21 @@ def filetime_to_datetime(filetime):
 class EverythingSDK:
     """Everything SDK Python 封装类"""
     
+    # 排序方式常量（Everything_SetSort，排序由 Everything 服务端完成）
+    EVERYTHING_SORT_NAME_ASCENDING = 1
+    EVERYTHING_SORT_NAME_DESCENDING = 2
+    EVERYTHING_SORT_SIZE_ASCENDING = 5
+    EVERYTHING_SORT_SIZE_DESCENDING = 6
+    EVERYTHING_SORT_DATE_MODIFIED_ASCENDING = 13
+    EVERYTHING_SORT_DATE_MODIFIED_DESCENDING = 14
+
+    # CLI 排序键 → (升序常量, 降序常量)
+    SORT_KEYS = {
+        'name': (EVERYTHING_SORT_NAME_ASCENDING, EVERYTHING_SORT_NAME_DESCENDING),
+        'size': (EVERYTHING_SORT_SIZE_ASCENDING, EVERYTHING_SORT_SIZE_DESCENDING),
+        'date-modified': (EVERYTHING_SORT_DATE_MODIFIED_ASCENDING, EVERYTHING_SORT_DATE_MODIFIED_DESCENDING),
+    }
+
     # 请求标志常量
     EVERYTHING_REQUEST_FILE_NAME = 0x00000001
     EVERYTHING_REQUEST_PATH = 0x00000002
@@ -193,10 +208,30 @@ class EverythingSDK:
             # Everything_GetLastError
             self.dll.Everything_GetLastError.argtypes = []
             self.dll.Everything_GetLastError.restype = wintypes.DWORD
-            
+
         except AttributeError as e:
             print(f"函数设置失败: {e}")
             raise
+
+        # 可选函数（旧版 DLL 可能缺失）：排序下推与总数统计
+        self.supports_sort = False
+        self.supports_totals = False
+        try:
+            self.dll.Everything_SetSort.argtypes = [wintypes.DWORD]
+            self.dll.Everything_SetSort.restype = None
+            self.supports_sort = True
+        except AttributeError:
+            print("提示: 此版本 Everything DLL 不支持 SetSort，排序将不可用", file=sys.stderr)
+        try:
+            self.dll.Everything_GetTotResults.argtypes = []
+            self.dll.Everything_GetTotResults.restype = wintypes.DWORD
+            self.dll.Everything_GetTotFileResults.argtypes = []
+            self.dll.Everything_GetTotFileResults.restype = wintypes.DWORD
+            self.dll.Everything_GetTotFolderResults.argtypes = []
+            self.dll.Everything_GetTotFolderResults.restype = wintypes.DWORD
+            self.supports_totals = True
+        except AttributeError:
+            pass
     
     def reset(self):
         """重置搜索状态"""
@@ -247,16 +282,70 @@ class EverythingSDK:
             error_code = self.dll.Everything_GetLastError()
             print(f"查询失败，错误代码: {error_code}")
             return [], 0, 0
-        
+
         # 获取结果统计
         num_results = self.dll.Everything_GetNumResults()
         num_files = self.dll.Everything_GetNumFileResults()
         num_folders = self.dll.Everything_GetNumFolderResults()
-        
+
+        results = self._collect_results(num_results)
+        return results, num_files, num_folders, num_results
+
+    def search_paged(self, query, offset=0, limit=100, sort=None, sort_descending=False,
+                     match_case=False, match_whole_word=False, regex=False):
+        """分页搜索：只取回一个结果窗口，排序下推给 Everything 服务端。
+
+        大通配查询（5 万+ 命中）不再把完整结果集经 ctypes 整体物化成
+        Python 列表——UI 一页显示多少就取多少，翻页用 offset。
+
+        Returns:
+            tuple: (当前窗口的结果列表, 文件总数, 文件夹总数, 结果总数)
+            总数为整个结果集的统计（需要 DLL 支持 GetTotResults，
+            否则退化为窗口内计数）。
+        """
+        self.reset()
+
+        request_flags = (
+            self.EVERYTHING_REQUEST_FILE_NAME |
+            self.EVERYTHING_REQUEST_PATH |
+            self.EVERYTHING_REQUEST_SIZE
+        )
+        self.dll.Everything_SetRequestFlags(request_flags)
+        self.set_search_options(match_case, match_whole_word, regex)
+
+        # 排序交给 Everything（索引端排序远快于在 Python 里排全量列表）
+        if sort and self.supports_sort and sort in self.SORT_KEYS:
+            asc, desc = self.SORT_KEYS[sort]
+            self.dll.Everything_SetSort(desc if sort_descending else asc)
+
+        self.dll.Everything_SetSearchW(query)
+        self.dll.Everything_SetOffset(offset)
+        self.dll.Everything_SetMax(limit)
+
+        if not self.dll.Everything_QueryW(True):
+            error_code = self.dll.Everything_GetLastError()
+            print(f"查询失败，错误代码: {error_code}", file=sys.stderr)
+            return [], 0, 0, 0
+
+        window_count = self.dll.Everything_GetNumResults()
+        if self.supports_totals:
+            total_results = self.dll.Everything_GetTotResults()
+            total_files = self.dll.Everything_GetTotFileResults()
+            total_folders = self.dll.Everything_GetTotFolderResults()
+        else:
+            total_results = window_count
+            total_files = self.dll.Everything_GetNumFileResults()
+            total_folders = self.dll.Everything_GetNumFolderResults()
+
+        results = self._collect_results(window_count)
+        return results, total_files, total_folders, total_results
+
+    def _collect_results(self, num_results):
+        """把当前查询窗口内的结果转换为字典列表。"""
         results = []
         buffer_size = 260  # MAX_PATH
         buffer = ctypes.create_unicode_buffer(buffer_size)
-        
+
         for i in range(num_results):
             try:
                 # 获取完整路径
@@ -300,8 +389,18 @@ class EverythingSDK:
             except Exception as e:
                 print(f"处理结果 {i} 时出错: {e}")
                 continue
-        
-        return results, num_files, num_folders, num_results
+
+        return results
+
+# 进程内共享的 SDK 实例：DLL 状态与 Everything IPC 会话在查询间保持热连接，
+# 不再为每次查询重新初始化
+_SDK_INSTANCE = None
+
+def get_everything():
+    global _SDK_INSTANCE
+    if _SDK_INSTANCE is None:
+        _SDK_INSTANCE = EverythingSDK()
+    return _SDK_INSTANCE
 
 def format_file_size(size_bytes):
     """格式化文件大小显示"""
@@ -433,12 +532,14 @@ Everything 搜索语法帮助:
 """
     print(help_text)
 
-def search_cli(query, max_results=100, match_case=False, match_whole_word=False, regex=False, dirs=None):
-    """CLI搜索功能，返回JSON格式的结果"""
+def search_cli(query, max_results=100, match_case=False, match_whole_word=False, regex=False, dirs=None,
+               offset=0, sort=None, sort_order='asc'):
+    """CLI搜索功能，返回JSON格式的结果（分页窗口 + 服务端排序）"""
     try:
-        # 初始化 Everything SDK
-        everything = EverythingSDK()
-        
+        # 复用进程内共享的 SDK 实例（IPC 会话保持热连接）
+        everything = get_everything()
+
+        search_dirs = []
         # [修改点] 重构路径处理逻辑
         if dirs:
             # 分割、清理用户输入的目录列表（例如 "J:\e, D:\My Documents"）
@@ -458,9 +559,11 @@ def search_cli(query, max_results=100, match_case=False, match_whole_word=False,
                 # 将路径限制附加到原始查询后面
                 query = f"{query} {dir_part}"
             
-        # 执行搜索
-        results, num_files, num_folders, num_results = everything.search(
-            query, max_results, match_case, match_whole_word, regex
+        # 执行搜索（分页窗口；排序由 Everything 服务端完成）
+        results, num_files, num_folders, num_results = everything.search_paged(
+            query, offset=offset, limit=max_results, sort=sort,
+            sort_descending=(sort_order == 'desc'),
+            match_case=match_case, match_whole_word=match_whole_word, regex=regex
         )
         
         # (函数其余部分保持不变)
@@ -493,6 +596,7 @@ def search_cli(query, max_results=100, match_case=False, match_whole_word=False,
             'success': True,
             'query_sent_to_everything': query,
             'results': results,
+            'offset': offset,
             'total_files': num_files,
             'total_folders': num_folders,
             'total_results': num_results
@@ -508,7 +612,49 @@ def search_cli(query, max_results=100, match_case=False, match_whole_word=False,
             'total_results': 0
         }
 
+def serve_stdio():
+    """常驻 worker 模式：从 stdin 逐行读取 NDJSON 查询，stdout 逐行写回结果。
+
+    请求格式:  {"id": <any>, "query": "...", "offset": 0, "maxResults": 100,
+               "sort": "size", "order": "desc", "dirs": "...",
+               "matchCase": false, "matchWholeWord": false, "useRegex": false}
+    响应格式:  {"id": <any>, ...search_cli 的返回值...}
+
+    DLL 只初始化一次，Everything IPC 会话在查询间保持热连接。
+    """
+    print("search.py worker ready (serve mode).", file=sys.stderr)
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        req_id = None
+        try:
+            request = json.loads(line)
+            req_id = request.get('id')
+            response = search_cli(
+                request.get('query', ''),
+                max_results=int(request.get('maxResults', 100)),
+                match_case=bool(request.get('matchCase', False)),
+                match_whole_word=bool(request.get('matchWholeWord', False)),
+                regex=bool(request.get('useRegex', False)),
+                dirs=request.get('dirs'),
+                offset=int(request.get('offset', 0)),
+                sort=request.get('sort'),
+                sort_order=request.get('order', 'asc')
+            )
+            response['id'] = req_id
+        except Exception as e:
+            response = {'id': req_id, 'success': False, 'error': str(e), 'results': []}
+        print(json.dumps(response, ensure_ascii=False, separators=(',', ':')), flush=True)
+
+
 if __name__ == "__main__":
+    # 常驻 worker 模式（由 server.js 维护，查询间保持 IPC 会话）
+    if '--serve' in sys.argv:
+        sys.stdout = io_wrapper = __import__('io').TextIOWrapper(sys.stdout.buffer, encoding='utf-8', line_buffering=True)
+        serve_stdio()
+        sys.exit(0)
+
     # 检查是否有命令行参数
     if len(sys.argv) > 1:
         import argparse
@@ -519,7 +665,10 @@ if __name__ == "__main__":
         parser.add_argument('--match-whole-word', action='store_true', help='全词匹配')
         parser.add_argument('--use-regex', action='store_true', help='使用正则表达式')
         parser.add_argument('--dirs', help='搜索目录列表，用逗号分隔')
-        
+        parser.add_argument('--offset', type=int, default=0, help='结果窗口起始偏移（分页用）')
+        parser.add_argument('--sort', choices=['name', 'size', 'date-modified'], help='排序键（由 Everything 服务端排序）')
+        parser.add_argument('--order', choices=['asc', 'desc'], default='asc', help='排序方向')
+
         args = parser.parse_args()
         
         # 解析目录参数
@@ -532,7 +681,10 @@ if __name__ == "__main__":
             args.match_case,
             args.match_whole_word,
             args.use_regex,
-            dirs
+            dirs,
+            offset=args.offset,
+            sort=args.sort,
+            sort_order=args.order
         )
         
         # 设置标准输出编码为UTF-8
@@ -91,6 +91,189 @@ def normalize_chinese(text):
             pass
         return s
 
+# --- 倒排索引 ---
+# 过去每次查询都要把 15k 条刮削 JSON 逐条解析并递归遍历（~4s）。
+# 这里在 videocache.db 旁边维护一张倒排索引表：标题/演员/厂商/类别/标签/番号
+# 在索引时就做 normalize_chinese + 小写规范化，查询只需一条 LIKE，
+# 并由 video_scraper.py 在写入新条目时增量更新。
+
+# 索引字段 → 刮削 JSON 中可能的键名（顶层与 jav_results 内均会提取）
+INDEXED_FIELDS = {
+    'title': ['title', 'title_cn', 'series_title', 'original_title', 'series'],
+    'actor': ['actors', 'actor', 'stars'],
+    'studio': ['studio', 'label', 'maker'],
+    'genre': ['genres', 'genre'],
+    'tags': ['tags', 'tag'],
+    'id': ['id', 'product_id'],
+}
+
+# 字段别名（支持 "字段:关键词" 语法的中英文字段名）
+FIELD_ALIASES = {
+    'title': 'title', '标题': 'title',
+    'actor': 'actor', 'actors': 'actor', '演员': 'actor', 'stars': 'actor',
+    'studio': 'studio', '厂商': 'studio', '制作商': 'studio', 'label': 'studio',
+    'genre': 'genre', 'genres': 'genre', '类别': 'genre', '类型': 'genre',
+    'tags': 'tags', 'tag': 'tags', '标签': 'tags',
+    'id': 'id', '番号': 'id',
+}
+
+
+def ensure_index_schema(conn):
+    """创建倒排索引表（幂等）。"""
+    conn.execute("""
+        CREATE TABLE IF NOT EXISTS search_index (
+            filename TEXT NOT NULL,
+            field TEXT NOT NULL,
+            value TEXT NOT NULL
+        )
+    """)
+    conn.execute("CREATE INDEX IF NOT EXISTS idx_search_index_value ON search_index(value)")
+    conn.execute("CREATE INDEX IF NOT EXISTS idx_search_index_filename ON search_index(filename)")
+    conn.execute("""
+        CREATE TABLE IF NOT EXISTS search_index_state (
+            filename TEXT PRIMARY KEY,
+            indexed_at TIMESTAMP
+        )
+    """)
+
+
+def extract_index_entries(scraped_data):
+    """从一条刮削 JSON 中提取 (field, 规范化 value) 索引项。"""
+    entries = set()
+
+    def add(field, value):
+        if isinstance(value, str):
+            norm = normalize_chinese(value).lower().strip()
+            if norm:
+                entries.add((field, norm))
+        elif isinstance(value, list):
+            for item in value:
+                add(field, item)
+
+    sources = [scraped_data]
+    jav_results = scraped_data.get('jav_results')
+    if isinstance(jav_results, list):
+        sources.extend(r for r in jav_results if isinstance(r, dict))
+
+    for source in sources:
+        if not isinstance(source, dict):
+            continue
+        for field, keys in INDEXED_FIELDS.items():
+            for key in keys:
+                if key in source:
+                    add(field, source[key])
+    return entries
+
+
+def update_index_for_entry(conn, filename, scraped_data):
+    """为单条记录（重新）建立索引。video_scraper.py 写入缓存后调用。"""
+    ensure_index_schema(conn)
+    cursor = conn.cursor()
+    cursor.execute("DELETE FROM search_index WHERE filename = ?", (filename,))
+    cursor.executemany(
+        "INSERT INTO search_index (filename, field, value) VALUES (?, ?, ?)",
+        [(filename, field, value) for field, value in extract_index_entries(scraped_data)]
+    )
+    cursor.execute(
+        "INSERT OR REPLACE INTO search_index_state (filename, indexed_at) VALUES (?, CURRENT_TIMESTAMP)",
+        (filename,)
+    )
+    conn.commit()
+
+
+def refresh_search_index(conn):
+    """增量刷新索引：只重建新增/更新过的记录，并清理已删除的记录。"""
+    ensure_index_schema(conn)
+    cursor = conn.cursor()
+
+    # 新增或更新过（video_info.updated_at 晚于上次索引时间）的记录
+    cursor.execute("""
+        SELECT v.filename, v.scraped_data
+        FROM video_info v
+        LEFT JOIN search_index_state s ON s.filename = v.filename
+        WHERE s.indexed_at IS NULL OR v.updated_at > s.indexed_at
+    """)
+    stale_rows = cursor.fetchall()
+    for filename, scraped_data_json in stale_rows:
+        try:
+            scraped_data = json.loads(scraped_data_json)
+        except json.JSONDecodeError:
+            continue
+        cursor.execute("DELETE FROM search_index WHERE filename = ?", (filename,))
+        cursor.executemany(
+            "INSERT INTO search_index (filename, field, value) VALUES (?, ?, ?)",
+            [(filename, field, value) for field, value in extract_index_entries(scraped_data)]
+        )
+        cursor.execute(
+            "INSERT OR REPLACE INTO search_index_state (filename, indexed_at) VALUES (?, CURRENT_TIMESTAMP)",
+            (filename,)
+        )
+
+    # 清理已从缓存中删除的记录
+    cursor.execute("DELETE FROM search_index WHERE filename NOT IN (SELECT filename FROM video_info)")
+    cursor.execute("DELETE FROM search_index_state WHERE filename NOT IN (SELECT filename FROM video_info)")
+    conn.commit()
+    if stale_rows:
+        print(f"[search_videos] 索引已更新 {len(stale_rows)} 条记录。", file=sys.stderr)
+
+
+def index_lookup(conn, search_term, search_key=None):
+    """在倒排索引中查找，返回匹配的 filename 集合。
+
+    匹配顺序：子串（天然覆盖前缀）→ difflib 模糊匹配兜底。
+    """
+    import difflib
+
+    norm_term = normalize_chinese(search_term).lower().strip()
+    if not norm_term:
+        return set()
+
+    field = None
+    if search_key:
+        field = FIELD_ALIASES.get(normalize_chinese(search_key).lower().strip())
+        if field is None:
+            # 未知字段名：退回全字段搜索（与旧行为"指定键不存在则全搜"一致）
+            pass
+
+    cursor = conn.cursor()
+    like_pattern = '%' + norm_term.replace('\\', '\\\\').replace('%', r'\%').replace('_', r'\_') + '%'
+    if field:
+        cursor.execute(
+            r"SELECT DISTINCT filename FROM search_index WHERE field = ? AND value LIKE ? ESCAPE '\'",
+            (field, like_pattern)
+        )
+    else:
+        cursor.execute(
+            r"SELECT DISTINCT filename FROM search_index WHERE value LIKE ? ESCAPE '\'",
+            (like_pattern,)
+        )
+    matches = {row[0] for row in cursor.fetchall()}
+    if matches:
+        return matches
+
+    # 模糊兜底：对索引中的去重值做相似度匹配（拼写近似、缺字等）
+    if field:
+        cursor.execute("SELECT DISTINCT value FROM search_index WHERE field = ?", (field,))
+    else:
+        cursor.execute("SELECT DISTINCT value FROM search_index")
+    values = [row[0] for row in cursor.fetchall()]
+    close = difflib.get_close_matches(norm_term, values, n=20, cutoff=0.6)
+    if not close:
+        return set()
+    placeholders = ','.join('?' * len(close))
+    if field:
+        cursor.execute(
+            f"SELECT DISTINCT filename FROM search_index WHERE field = ? AND value IN ({placeholders})",
+            [field] + close
+        )
+    else:
+        cursor.execute(
+            f"SELECT DISTINCT filename FROM search_index WHERE value IN ({placeholders})",
+            close
+        )
+    return {row[0] for row in cursor.fetchall()}
+
+
 def search_value_in_json(data, search_term, search_key=None):
     """
     递归搜索 JSON 对象（字典或列表）中是否包含指定的搜索词。
@@ -181,59 +364,77 @@ def search_database(search_query):
         conn = sqlite3.connect(DB_PATH)
         cursor = conn.cursor()
 
-        # 获取所有数据
-        cursor.execute("SELECT filename, scraped_data, poster_path FROM video_info")
-        rows = cursor.fetchall()
-        
+        # 倒排索引路径：增量刷新后用一条 LIKE 查询取回匹配的 filename，
+        # 只为命中的条目解析 JSON（旧实现要解析全部 15k 条）
+        try:
+            refresh_search_index(conn)
+            matched_filenames = index_lookup(conn, search_term, search_key)
+            if matched_filenames:
+                placeholders = ','.join('?' * len(matched_filenames))
+                cursor.execute(
+                    f"SELECT filename, scraped_data, poster_path FROM video_info WHERE filename IN ({placeholders})",
+                    list(matched_filenames)
+                )
+                rows = cursor.fetchall()
+            else:
+                rows = []
+        except sqlite3.Error as e:
+            # 索引不可用（旧库/并发建表竞争等）：退回全量扫描
+            print(f"[search_videos] 索引查询失败，退回全量扫描: {e}", file=sys.stderr)
+            cursor.execute("SELECT filename, scraped_data, poster_path FROM video_info")
+            rows = [row for row in cursor.fetchall()]
+            rows = [
+                row for row in rows
+                if _row_matches_fullscan(row[1], search_term, search_key)
+            ]
+
         conn.close()
 
         results = []
         for row in rows:
             filepath, scraped_data_json, local_poster_path = row
-            
+
             try:
                 scraped_data = json.loads(scraped_data_json)
             except json.JSONDecodeError:
                 # 如果JSON解析失败，则跳过此条目
                 continue
 
-            # 检查搜索词是否存在于任何值中
-            if search_value_in_json(scraped_data, search_term, search_key):
-                # --- 提取文件路径 ---
-                # 优先从 scraped_data['file_info']['path'] 获取最准确的路径
-                # 如果不存在，则回退到使用数据库中的 filename 字段
-                authoritative_filepath = scraped_data.get('file_info', {}).get('path', filepath)
-
-                # 提取所需信息
-                # 标题的可能键名
-                title_keys = ['title', 'title_cn', 'series_title', 'jav_results']
-                title = find_best_value(scraped_data, title_keys, "标题未找到")
-                
-                # --- 提取番号 (ID) 的逻辑 ---
-                # 优先级: JAV结果 -> 顶层ID (FC2) -> guessit解析结果 -> 其他备用键
-                video_id = "番号未找到"
-                if 'jav_results' in scraped_data and isinstance(scraped_data['jav_results'], list) and scraped_data['jav_results']:
-                    video_id = scraped_data['jav_results'][0].get('id', video_id)
-                
-                if video_id == "番号未找到" and 'id' in scraped_data:
-                    video_id = scraped_data.get('id', video_id)
-
-                if video_id == "番号未找到" and 'file_info' in scraped_data:
-                    guessit_info = scraped_data.get('file_info', {}).get('parsed_by_guessit', {})
-                    if guessit_info:
-                        video_id = guessit_info.get('id', video_id)
-
-                if video_id == "番号未找到":
-                    video_id = scraped_data.get('product_id', video_id)
-
-                # 检查文件是否确实存在
-                if os.path.exists(authoritative_filepath):
-                    results.append({
-                        "title": title,
-                        "id": video_id,
-                        "local_poster_path": local_poster_path if local_poster_path else "无本地海报",
-                        "filepath": authoritative_filepath
-                    })
+            # --- 提取文件路径 ---
+            # 优先从 scraped_data['file_info']['path'] 获取最准确的路径
+            # 如果不存在，则回退到使用数据库中的 filename 字段
+            authoritative_filepath = scraped_data.get('file_info', {}).get('path', filepath)
+
+            # 提取所需信息
+            # 标题的可能键名
+            title_keys = ['title', 'title_cn', 'series_title', 'jav_results']
+            title = find_best_value(scraped_data, title_keys, "标题未找到")
+
+            # --- 提取番号 (ID) 的逻辑 ---
+            # 优先级: JAV结果 -> 顶层ID (FC2) -> guessit解析结果 -> 其他备用键
+            video_id = "番号未找到"
+            if 'jav_results' in scraped_data and isinstance(scraped_data['jav_results'], list) and scraped_data['jav_results']:
+                video_id = scraped_data['jav_results'][0].get('id', video_id)
+
+            if video_id == "番号未找到" and 'id' in scraped_data:
+                video_id = scraped_data.get('id', video_id)
+
+            if video_id == "番号未找到" and 'file_info' in scraped_data:
+                guessit_info = scraped_data.get('file_info', {}).get('parsed_by_guessit', {})
+                if guessit_info:
+                    video_id = guessit_info.get('id', video_id)
+
+            if video_id == "番号未找到":
+                video_id = scraped_data.get('product_id', video_id)
+
+            # 检查文件是否确实存在
+            if os.path.exists(authoritative_filepath):
+                results.append({
+                    "title": title,
+                    "id": video_id,
+                    "local_poster_path": local_poster_path if local_poster_path else "无本地海报",
+                    "filepath": authoritative_filepath
+                })
 
         return results
 
@@ -241,6 +442,15 @@ def search_database(search_query):
         print(f"数据库错误: {e}", file=sys.stderr)
         return None
 
+
+def _row_matches_fullscan(scraped_data_json, search_term, search_key):
+    """全量扫描兜底路径的单行匹配（旧实现的递归 JSON 搜索）。"""
+    try:
+        scraped_data = json.loads(scraped_data_json)
+    except json.JSONDecodeError:
+        return False
+    return search_value_in_json(scraped_data, search_term, search_key)
+
 def main():
     """
     主函数，处理用户输入和结果输出。
@@ -5,6 +5,10 @@ import faiss
 import numpy as np
 import pickle
 import os
+import hashlib
+
+# 向量缓存目录（与 subtitle_process_backend.py 的索引缓存同级）
+EMBED_CACHE_DIR = os.path.join(".", "cache", "vectordata")
 
 # 1. 读取 VTT 字幕
 def load_vtt(vtt_file, max_gap_seconds=5.0, max_chunk_length=300):
@@ -78,13 +82,104 @@ def load_vtt(vtt_file, max_gap_seconds=5.0, max_chunk_length=300):
     return entries
 
 # 2. 向量化并构建 Faiss 索引
-def build_index(entries, model):
-    """使用预加载的模型为字幕文本构建 Faiss 索引。"""
+def _chunk_hash(text):
+    """文本块的内容哈希，用于增量编码时识别未变化的块。"""
+    return hashlib.md5(text.encode('utf-8')).hexdigest()
+
+
+def _embed_store_paths(vtt_file, model_name):
+    """返回某个 (VTT 文件, 模型) 组合的向量存储路径 (矩阵 .npy, 哈希列表 .pkl)。"""
+    key = hashlib.md5((os.path.abspath(vtt_file) + "::" + model_name).encode('utf-8')).hexdigest()
+    return (
+        os.path.join(EMBED_CACHE_DIR, key + ".emb.npy"),
+        os.path.join(EMBED_CACHE_DIR, key + ".emb_hashes.pkl"),
+    )
+
+
+def _load_embed_store(vtt_file, model_name):
+    """加载持久化的向量存储。矩阵以 mmap 方式打开，只有用到的行才会真正读盘。
+
+    返回 (matrix, hash→行号 dict)；无缓存或缓存损坏时返回 (None, {})。
+    """
+    emb_path, hashes_path = _embed_store_paths(vtt_file, model_name)
+    if not (os.path.exists(emb_path) and os.path.exists(hashes_path)):
+        return None, {}
+    try:
+        matrix = np.load(emb_path, mmap_mode='r')
+        with open(hashes_path, 'rb') as f:
+            hashes = pickle.load(f)
+        if matrix.shape[0] != len(hashes):
+            return None, {}
+        return matrix, {h: i for i, h in enumerate(hashes)}
+    except Exception as e:
+        print(f"  - 警告：加载向量缓存失败，将重新编码: {e}")
+        return None, {}
+
+
+def _save_embed_store(vtt_file, model_name, embeddings, chunk_hashes):
+    """把当前文件所有块的向量写回持久化存储（旧版本的陈旧块随之淘汰）。"""
+    emb_path, hashes_path = _embed_store_paths(vtt_file, model_name)
+    try:
+        os.makedirs(EMBED_CACHE_DIR, exist_ok=True)
+        np.save(emb_path, np.asarray(embeddings, dtype=np.float32))
+        with open(hashes_path, 'wb') as f:
+            pickle.dump(chunk_hashes, f)
+    except Exception as e:
+        print(f"  - 警告：保存向量缓存失败: {e}")
+
+
+def encode_entries(entries, model, vtt_file=None, model_name="default"):
+    """把字幕文本块编码为归一化向量（float32 矩阵）。
+
+    传入 vtt_file 时启用持久化向量缓存：向量按文本块内容哈希存盘，
+    再次编码时只处理文本发生变化的块，未变化的块直接从
+    内存映射的缓存矩阵中取行，首查之后的重编码只需毫秒级。
+    """
     texts = [e["text"] for e in entries]
-    print(f"  - 正在将 {len(texts)} 条字幕编码为向量...")
-    embeddings = model.encode(texts, normalize_embeddings=True, show_progress_bar=True)
-    print("  - 编码完成。")
-    
+    embeddings = None
+
+    if vtt_file and texts:
+        chunk_hashes = [_chunk_hash(t) for t in texts]
+        cached_matrix, hash_to_row = _load_embed_store(vtt_file, model_name)
+        missing = [i for i, h in enumerate(chunk_hashes) if h not in hash_to_row]
+
+        if cached_matrix is not None and not missing:
+            # 全部命中：直接从 mmap 矩阵取行，无需任何编码
+            rows = [hash_to_row[h] for h in chunk_hashes]
+            embeddings = np.ascontiguousarray(cached_matrix[rows], dtype=np.float32)
+            print(f"  - 向量缓存全部命中（{len(texts)} 块），跳过编码。")
+        else:
+            hit_count = len(texts) - len(missing)
+            if hit_count > 0:
+                print(f"  - 向量缓存命中 {hit_count}/{len(texts)} 块，只编码变化的 {len(missing)} 块...")
+            else:
+                print(f"  - 正在将 {len(texts)} 条字幕编码为向量...")
+            new_embeddings = model.encode(
+                [texts[i] for i in missing],
+                normalize_embeddings=True,
+                show_progress_bar=True
+            )
+            dim = new_embeddings.shape[1] if len(missing) else cached_matrix.shape[1]
+            embeddings = np.empty((len(texts), dim), dtype=np.float32)
+            new_iter = iter(new_embeddings)
+            for i, h in enumerate(chunk_hashes):
+                if h in hash_to_row:
+                    embeddings[i] = cached_matrix[hash_to_row[h]]
+                else:
+                    embeddings[i] = next(new_iter)
+            print("  - 编码完成。")
+            _save_embed_store(vtt_file, model_name, embeddings, chunk_hashes)
+    if embeddings is None:
+        print(f"  - 正在将 {len(texts)} 条字幕编码为向量...")
+        embeddings = model.encode(texts, normalize_embeddings=True, show_progress_bar=True)
+        print("  - 编码完成。")
+    return np.asarray(embeddings, dtype=np.float32)
+
+
+def build_index(entries, model, vtt_file=None, model_name="default"):
+    """使用预加载的模型为字幕文本构建 Faiss 索引（向量缓存见 encode_entries）。"""
+    embeddings = encode_entries(entries, model, vtt_file=vtt_file, model_name=model_name)
+
     dim = embeddings.shape[1]
     print("  - 正在创建 Faiss 索引...")
     index = faiss.IndexFlatIP(dim)  # 内积检索
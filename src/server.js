@@ -2,8 +2,9 @@ const http = require('http');
 const fs = require('fs');
 const path = require('path');
 const url = require('url');
-const { spawn } = require('child_process');
+const { spawn: spawnRaw } = require('child_process');
 const crypto = require('crypto');
+const os = require('os');
 const WebSocket = require('ws');
 const { exec } = require('child_process');
 const https = require('https');
@@ -18,15 +19,386 @@ const MUSIC_DIR = MEDIA_DIRS.find(d => d.alias === 'MUSIC')?.path || path.join(_
 let currentMediaDir = MEDIA_DIRS[0].path; // 默认使用第一个媒体目录
 const WEB_ROOT = __dirname; // 静态文件（如 index.html）的根目录
 
+// 媒体流读取缓冲：大块顺序读降低 4K 视频流的每字节系统调用开销
+// （Node 的 http 层无法直接 sendfile，大而对齐的读缓冲是等价的退而求其次）
+const MEDIA_STREAM_HIGH_WATER = (config.media_stream_buffer_kb || 1024) * 1024;
+
+// ============================================================
+// 性能指标：每端点延迟直方图 + 子进程统计（/api/perf 暴露）
+// ============================================================
+const { createPerfMetrics } = require('./perf-metrics');
+const perf = createPerfMetrics();
+
+// 包装 spawn：按命令（python 取脚本名）统计启动次数/时长/并发 gauge
+function spawn(command, args, options) {
+    let label = command;
+    if (command === 'python' && Array.isArray(args)) {
+        const script = args.find(a => typeof a === 'string' && a.endsWith('.py'));
+        if (script) label = path.basename(script);
+    }
+    const endSpawn = perf.spawnStarted(label);
+    const proc = spawnRaw(command, args, options);
+    proc.on('error', () => endSpawn(-1));
+    proc.on('close', (code) => endSpawn(code));
+    return proc;
+}
+
+// 端点归一化：动态段折叠，避免指标基数爆炸
+function perfEndpointKey(pathname) {
+    if (pathname.startsWith('/api/subtitle/')) return '/api/subtitle';
+    if (pathname.startsWith('/api/folder-thumbnail')) return '/api/folder-thumbnail';
+    if (pathname.startsWith('/api/')) return pathname;
+    if (pathname.startsWith('/thumbnail')) return '/thumbnail';
+    if (pathname.startsWith('/list')) return '/list';
+    if (pathname.startsWith('/hls/')) return '/hls';
+    if (pathname.startsWith('/cache/')) return '/cache';
+    if (pathname.startsWith('/node_modules/')) return '/node_modules';
+    if (pathname === '/') return '/';
+    return '/static';
+}
+
+// 进程内共享缓存：多设备并发访问时相同请求不再重复 stat / 跑 Python
+const { createMemoryCache } = require('./memory-cache');
+const memCache = createMemoryCache({ maxBytes: (config.memory_cache_mb || 256) * 1024 * 1024 });
+const musicInfoMemCache = memCache.namespace('music-info', { ttlSeconds: 300 });
+const audioInfoMemCache = memCache.namespace('audio-info', { ttlSeconds: 3600 });
+const listingMemCache = memCache.namespace('listing', { ttlSeconds: 30 });
+const cacheInfoMemCache = memCache.namespace('cache-info', { ttlSeconds: 30 });
+
 // VBR→CBR 代理流：跟踪每个客户端的活跃 ffmpeg 进程
 const activeFFmpegProcesses = new Map();
-// 进程退出时清理所有 ffmpeg
+// 进程退出时清理所有 ffmpeg 以及常驻 Python worker
 process.on('exit', () => {
     for (const [, proc] of activeFFmpegProcesses) {
         try { proc.kill('SIGTERM'); } catch (e) { }
     }
+    for (const worker of musicInfoPool.workers) {
+        try { worker.proc.kill('SIGTERM'); } catch (e) { }
+    }
+    if (searchWorker.proc) {
+        try { searchWorker.proc.kill('SIGTERM'); } catch (e) { }
+    }
 });
 
+// ============================================================
+// VBR→CBR 分段缓存
+// ============================================================
+// 每个源文件按固定时长切成 CBR 分段懒转码到磁盘，命中的分段直接回放。
+const CBR_SEGMENT_DURATION = 10; // 每个分段的时长（秒）
+const CBR_SEGMENT_DIR = path.join(__dirname, 'cache', 'cbr_segments');
+const cbrSegmentInflight = new Map(); // 分段路径 → 转码中的 Promise（并发去重）
+const audioDurationCache = new Map(); // 源文件路径 → 时长（秒）
+
+// ffprobe 获取音频时长（带内存缓存，每个文件只探测一次）
+function getAudioDurationSec(fullAudioPath) {
+    if (audioDurationCache.has(fullAudioPath)) {
+        return Promise.resolve(audioDurationCache.get(fullAudioPath));
+    }
+    return new Promise((resolve, reject) => {
+        const ffprobe = spawn('ffprobe', [
+            '-v', 'quiet',
+            '-show_entries', 'format=duration',
+            '-of', 'json',
+            fullAudioPath
+        ]);
+        let output = '';
+        ffprobe.stdout.on('data', d => output += d);
+        ffprobe.on('error', reject);
+        ffprobe.on('close', (code) => {
+            if (code !== 0) {
+                reject(new Error('ffprobe failed for ' + fullAudioPath));
+                return;
+            }
+            try {
+                const duration = parseFloat(JSON.parse(output).format?.duration || 0);
+                if (!duration || !isFinite(duration)) {
+                    reject(new Error('Could not determine audio duration'));
+                    return;
+                }
+                audioDurationCache.set(fullAudioPath, duration);
+                resolve(duration);
+            } catch (e) {
+                reject(e);
+            }
+        });
+    });
+}
+
+// 确保某个分段已物化到磁盘；缓存命中时不产生任何 ffmpeg 进程
+function ensureCbrSegment(fullAudioPath, segIndex, bitrateK, clientId) {
+    const keyHash = crypto.createHash('md5').update(fullAudioPath).digest('hex');
+    const segDir = path.join(CBR_SEGMENT_DIR, keyHash);
+    const segPath = path.join(segDir, `${bitrateK}k-${segIndex}.mp3`);
+
+    if (fs.existsSync(segPath)) {
+        return Promise.resolve(segPath);
+    }
+    // 另一个请求正在转码同一分段：直接等它完成
+    if (cbrSegmentInflight.has(segPath)) {
+        return cbrSegmentInflight.get(segPath);
+    }
+
+    const promise = new Promise((resolve, reject) => {
+        fs.mkdirSync(segDir, { recursive: true });
+        // 先写临时文件，成功后原子重命名，避免半成品分段被后续请求命中
+        const tmpPath = segPath + '.tmp';
+        const ffmpeg = spawn('ffmpeg', [
+            '-hide_banner', '-loglevel', 'warning',
+            '-ss', String(segIndex * CBR_SEGMENT_DURATION),
+            '-t', String(CBR_SEGMENT_DURATION),
+            '-i', fullAudioPath,
+            '-c:a', 'libmp3lame',
+            '-b:a', `${bitrateK}k`,
+            '-f', 'mp3',
+            '-y', tmpPath
+        ]);
+        activeFFmpegProcesses.set(clientId, ffmpeg);
+
+        ffmpeg.stderr.on('data', d => {
+            const msg = d.toString().trim();
+            if (msg) console.log(`[CBR Proxy ffmpeg] ${msg}`);
+        });
+        ffmpeg.on('error', (err) => {
+            cbrSegmentInflight.delete(segPath);
+            reject(err);
+        });
+        ffmpeg.on('close', (code) => {
+            if (activeFFmpegProcesses.get(clientId) === ffmpeg) {
+                activeFFmpegProcesses.delete(clientId);
+            }
+            cbrSegmentInflight.delete(segPath);
+            if (code === 0) {
+                try {
+                    fs.renameSync(tmpPath, segPath);
+                    resolve(segPath);
+                } catch (e) {
+                    reject(e);
+                }
+            } else {
+                try { fs.unlinkSync(tmpPath); } catch (e) { }
+                reject(new Error(`ffmpeg exited with code ${code} for segment ${segIndex}`));
+            }
+        });
+    });
+    cbrSegmentInflight.set(segPath, promise);
+    return promise;
+}
+
+// 把一个分段文件写入响应（可选片内字节偏移与剩余字节预算）。
+// 返回实际写出的字节数；-1 表示流中断（客户端断开或读取失败）。
+// res.write() 返回 false 时暂停读取、等待 drain 再继续——分段缓存
+// 全命中时磁盘远快于慢客户端，没有背压会把整个剩余文件堆进响应缓冲。
+function pipeCbrSegment(segPath, res, startByte, maxBytes) {
+    return new Promise((resolve) => {
+        let written = 0;
+        let settled = false;
+        const stream = fs.createReadStream(segPath, startByte > 0 ? { start: startByte } : {});
+        const finish = (result) => {
+            if (settled) return;
+            settled = true;
+            res.removeListener('close', onResClose);
+            res.removeListener('drain', onDrain);
+            stream.destroy();
+            resolve(result);
+        };
+        const onResClose = () => finish(-1);
+        const onDrain = () => stream.resume();
+
+        stream.on('error', (err) => {
+            console.error(`[CBR Proxy] Error reading segment ${segPath}:`, err.message);
+            finish(-1);
+        });
+        stream.on('data', (chunk) => {
+            // Range 请求带上限时裁剪最后一块
+            if (maxBytes !== null && written + chunk.length > maxBytes) {
+                res.write(chunk.slice(0, maxBytes - written));
+                written = maxBytes;
+                finish(written);
+                return;
+            }
+            const canContinue = res.write(chunk);
+            written += chunk.length;
+            if (!canContinue) {
+                // 响应缓冲已满：暂停读盘，drain 后恢复
+                stream.pause();
+            }
+        });
+        stream.on('end', () => finish(written));
+        res.once('close', onResClose);
+        res.on('drain', onDrain);
+    });
+}
+
+// 从 startTime 开始逐分段流式输出，直到文件结束、达到 Range 上限或客户端断开
+async function streamCbrFromSegments(fullAudioPath, startTime, duration, bitrateK, clientId, req, res, maxBytes = null) {
+    const bytesPerSec = bitrateK * 1000 / 8;
+    let aborted = false;
+    const onClose = () => { aborted = true; };
+    req.on('close', onClose);
+    res.on('error', onClose);
+
+    let remaining = maxBytes;
+    const firstSeg = Math.floor(startTime / CBR_SEGMENT_DURATION);
+    for (let i = firstSeg; i * CBR_SEGMENT_DURATION < duration; i++) {
+        if (aborted || res.writableEnded) break;
+        if (remaining !== null && remaining <= 0) break;
+        let segPath;
+        try {
+            segPath = await ensureCbrSegment(fullAudioPath, i, bitrateK, clientId);
+        } catch (err) {
+            // 分段转码失败或被更新的请求中断：结束本条流
+            console.error(`[CBR Proxy] Segment ${i} unavailable:`, err.message);
+            break;
+        }
+        if (aborted || res.writableEnded) break;
+        // seek 落在分段中间时跳过片内字节（MP3 解码器会自动重新同步到帧边界）
+        const startByte = (i === firstSeg)
+            ? Math.max(0, Math.floor((startTime - i * CBR_SEGMENT_DURATION) * bytesPerSec))
+            : 0;
+        const written = await pipeCbrSegment(segPath, res, startByte, remaining);
+        if (written < 0) break;
+        if (remaining !== null) remaining -= written;
+    }
+    if (!res.writableEnded) res.end();
+}
+
+// ============================================================
+// 常驻 get_music_info.py worker 池
+// ============================================================
+// /api/music-info 和 /api/fetch-info 过去为每个请求 spawn 一个新的
+// Python 进程，每次都要付出解释器 + mutagen/requests 的导入冷启动开销
+// （每个磁贴 600-900ms）。这里改为维护若干个 `get_music_info.py --serve`
+// 常驻 worker，通过 stdio 上的 NDJSON 协议分发请求，worker 忙时排队。
+const MUSIC_INFO_POOL_SIZE = config.music_info_pool_size || 2;
+const MUSIC_INFO_REQUEST_TIMEOUT_MS = (config.music_info_request_timeout_seconds || 120) * 1000;
+
+const musicInfoPool = {
+    workers: [],      // { proc, busy, buffer, pending: { id, resolve, reject, timer } }
+    queue: [],        // 等待空闲 worker 的任务 { argv, resolve, reject }
+    nextRequestId: 1
+};
+
+function spawnMusicInfoWorker() {
+    const proc = spawn('python', [path.join(__dirname, 'get_music_info.py'), '--serve'], {
+        env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
+    });
+    const worker = { proc, busy: false, buffer: '', pending: null };
+
+    proc.stdout.on('data', (data) => {
+        worker.buffer += data.toString();
+        let newlineIdx;
+        while ((newlineIdx = worker.buffer.indexOf('\n')) !== -1) {
+            const line = worker.buffer.slice(0, newlineIdx).trim();
+            worker.buffer = worker.buffer.slice(newlineIdx + 1);
+            if (!line) continue;
+            let response;
+            try {
+                response = JSON.parse(line);
+            } catch (e) {
+                console.error('[music-info pool] Failed to parse worker response:', line);
+                continue;
+            }
+            const pending = worker.pending;
+            if (pending && response.id === pending.id) {
+                clearTimeout(pending.timer);
+                worker.pending = null;
+                worker.busy = false;
+                pending.resolve(response);
+                pumpMusicInfoQueue();
+            }
+        }
+    });
+
+    proc.stderr.on('data', (data) => {
+        const msg = data.toString().trim();
+        if (msg) console.error(`get_music_info.py stderr: ${msg}`);
+    });
+
+    proc.on('error', (err) => {
+        console.error('[music-info pool] Worker spawn error:', err.message);
+    });
+
+    proc.on('close', (code) => {
+        // 从池中移除；崩溃时拒绝挂起的请求，让客户端重试
+        const idx = musicInfoPool.workers.indexOf(worker);
+        if (idx !== -1) musicInfoPool.workers.splice(idx, 1);
+        if (worker.pending) {
+            clearTimeout(worker.pending.timer);
+            const pending = worker.pending;
+            worker.pending = null;
+            pending.reject(new Error(`music info worker exited with code ${code}`));
+        }
+        pumpMusicInfoQueue();
+    });
+
+    musicInfoPool.workers.push(worker);
+    return worker;
+}
+
+// argv 与单次调用 get_music_info.py 时的命令行参数一致（不含脚本路径）
+function dispatchMusicInfoRequest(argv) {
+    return dispatchMusicInfoOp({ argv });
+}
+
+// 发送任意 serve 协议请求（如 { op: 'batch_db_lookup', paths: [...] }）
+function dispatchMusicInfoOp(payload) {
+    return new Promise((resolve, reject) => {
+        musicInfoPool.queue.push({ payload, resolve, reject });
+        pumpMusicInfoQueue();
+    });
+}
+
+function pumpMusicInfoQueue() {
+    while (musicInfoPool.queue.length > 0) {
+        let worker = musicInfoPool.workers.find(w => !w.busy);
+        if (!worker) {
+            if (musicInfoPool.workers.length < MUSIC_INFO_POOL_SIZE) {
+                worker = spawnMusicInfoWorker();
+            } else {
+                return; // 所有 worker 都忙，任务留在队列中
+            }
+        }
+        const job = musicInfoPool.queue.shift();
+        const id = musicInfoPool.nextRequestId++;
+        worker.busy = true;
+        const timer = setTimeout(() => {
+            console.error(`[music-info pool] Request ${id} timed out, restarting worker`);
+            worker.pending = null;
+            try { worker.proc.kill('SIGTERM'); } catch (e) { }
+            job.reject(new Error('music info request timed out'));
+        }, MUSIC_INFO_REQUEST_TIMEOUT_MS);
+        worker.pending = { id, resolve: job.resolve, reject: job.reject, timer };
+        try {
+            worker.proc.stdin.write(JSON.stringify({ id, ...job.payload }) + '\n');
+        } catch (e) {
+            clearTimeout(timer);
+            worker.pending = null;
+            worker.busy = false;
+            job.reject(e);
+        }
+    }
+}
+
+// 请求计时包装：res 结束时记录端点延迟（空闲零开销）
+const instrumentedHandler = (req, res) => {
+    const startTime = process.hrtime.bigint();
+    let recorded = false;
+    const record = () => {
+        if (recorded) return;
+        recorded = true;
+        let endpoint;
+        try {
+            endpoint = perfEndpointKey(decodeURIComponent(url.parse(req.url).pathname || '/'));
+        } catch (e) {
+            endpoint = '/static';
+        }
+        perf.recordRequest(endpoint, Number(process.hrtime.bigint() - startTime) / 1e6);
+    };
+    res.on('finish', record);
+    res.on('close', record);
+    return requestHandler(req, res);
+};
+
 const requestHandler = async (req, res) => {
     const parsedUrl = url.parse(req.url, true);
     // 安全地解码路径，处理可能的编码错误
@@ -49,11 +421,14 @@ const requestHandler = async (req, res) => {
     // (activeFFmpegProcesses 定义在 server handler 外部)
 
     // --- CBR 代理流 API ---
+    // 分段缓存：按固定时长把源文件懒转码成 CBR 分段（cache/cbr_segments/），
+    // 已物化的分段直接从磁盘回放，seek 与重复收听不再重启整条 ffmpeg 管线。
+    // CBR 码率恒定，字节偏移与时间线性对应，因此还能支持 HTTP Range 请求。
     if (pathname === '/api/audio-cbr') {
         const audioPath = parsedUrl.query.path;
-        const startTime = parseFloat(parsedUrl.query.t || '0');
+        let startTime = parseFloat(parsedUrl.query.t || '0');
         const clientId = parsedUrl.query.cid || 'default';
-        const bitrateK = parsedUrl.query.br || '192';
+        const bitrateK = parseInt(parsedUrl.query.br || '192', 10);
 
         if (!audioPath) {
             res.statusCode = 400;
@@ -76,7 +451,7 @@ const requestHandler = async (req, res) => {
             return;
         }
 
-        // 清理该客户端之前的 ffmpeg 进程
+        // 清理该客户端之前的 ffmpeg 进程（重新 seek 时中断未完成的分段转码）
         if (activeFFmpegProcesses.has(clientId)) {
             const old = activeFFmpegProcesses.get(clientId);
             console.log(`[CBR Proxy] Killing old ffmpeg for client ${clientId}`);
@@ -84,54 +459,47 @@ const requestHandler = async (req, res) => {
             activeFFmpegProcesses.delete(clientId);
         }
 
-        console.log(`[CBR Proxy] Stream: file=${path.basename(fullAudioPath)}, t=${startTime}s, br=${bitrateK}k, cid=${clientId}`);
-
-        const ffmpegArgs = ['-hide_banner', '-loglevel', 'warning'];
-        if (startTime > 0) {
-            ffmpegArgs.push('-ss', String(startTime));
-        }
-        ffmpegArgs.push(
-            '-i', fullAudioPath,
-            '-c:a', 'libmp3lame',
-            '-b:a', `${bitrateK}k`,
-            '-f', 'mp3',
-            '-fflags', '+genpts',
-            'pipe:1'
-        );
-
-        const ffmpeg = spawn('ffmpeg', ffmpegArgs, { stdio: ['pipe', 'pipe', 'pipe'] });
-        activeFFmpegProcesses.set(clientId, ffmpeg);
-
-        ffmpeg.stderr.on('data', d => {
-            const msg = d.toString().trim();
-            if (msg) console.log(`[CBR Proxy ffmpeg] ${msg}`);
-        });
-
-        res.setHeader('Content-Type', 'audio/mpeg');
-        res.setHeader('Cache-Control', 'no-store, no-cache');
-        res.setHeader('Access-Control-Allow-Origin', '*');
-
-        ffmpeg.stdout.pipe(res);
-
-        const cleanup = () => {
-            if (activeFFmpegProcesses.get(clientId) === ffmpeg) {
-                activeFFmpegProcesses.delete(clientId);
+        try {
+            const duration = await getAudioDurationSec(fullAudioPath);
+            const bytesPerSec = bitrateK * 1000 / 8;
+            // 估算的总字节数（CBR 下与实际输出只差帧头/填充的零头）
+            const totalBytes = Math.max(1, Math.floor(duration * bytesPerSec));
+
+            // HTTP Range：字节偏移在 CBR 下线性映射回时间
+            let rangeStart = null;
+            let rangeEnd = null;
+            const rangeMatch = (req.headers.range || '').match(/bytes=(\d+)-(\d*)/);
+            if (rangeMatch) {
+                rangeStart = parseInt(rangeMatch[1], 10);
+                if (rangeStart >= totalBytes) {
+                    res.statusCode = 416;
+                    res.setHeader('Content-Range', `bytes */${totalBytes}`);
+                    res.end();
+                    return;
+                }
+                rangeEnd = rangeMatch[2] ? Math.min(parseInt(rangeMatch[2], 10), totalBytes - 1) : totalBytes - 1;
+                startTime = rangeStart / bytesPerSec;
             }
-            try { ffmpeg.kill('SIGTERM'); } catch (e) { }
-        };
 
-        req.on('close', cleanup);
-        req.on('error', cleanup);
-        res.on('error', cleanup);
-        ffmpeg.on('error', (err) => {
-            console.error(`[CBR Proxy] ffmpeg error:`, err.message);
-            cleanup();
-        });
-        ffmpeg.on('close', (code) => {
-            if (activeFFmpegProcesses.get(clientId) === ffmpeg) {
-                activeFFmpegProcesses.delete(clientId);
+            res.setHeader('Content-Type', 'audio/mpeg');
+            res.setHeader('Accept-Ranges', 'bytes');
+            res.setHeader('Cache-Control', 'no-store, no-cache');
+            res.setHeader('Access-Control-Allow-Origin', '*');
+            let maxBytes = null;
+            if (rangeStart !== null) {
+                res.statusCode = 206;
+                res.setHeader('Content-Range', `bytes ${rangeStart}-${rangeEnd}/${totalBytes}`);
+                maxBytes = rangeEnd - rangeStart + 1;
             }
-        });
+
+            console.log(`[CBR Proxy] Stream: file=${path.basename(fullAudioPath)}, t=${startTime.toFixed(1)}s, br=${bitrateK}k, cid=${clientId}, range=${rangeStart !== null ? `${rangeStart}-${rangeEnd}` : 'none'}`);
+
+            await streamCbrFromSegments(fullAudioPath, startTime, duration, bitrateK, clientId, req, res, maxBytes);
+        } catch (err) {
+            console.error('[CBR Proxy] Error:', err.message);
+            if (!res.headersSent) res.statusCode = 500;
+            if (!res.writableEnded) res.end();
+        }
         return;
     }
 
@@ -153,7 +521,10 @@ const requestHandler = async (req, res) => {
             fullAudioPath = path.join(MUSIC_DIR, audioPath);
         }
 
-        if (!fs.existsSync(fullAudioPath)) {
+        let audioStats;
+        try {
+            audioStats = fs.statSync(fullAudioPath);
+        } catch (e) {
             res.statusCode = 404;
             res.setHeader('Content-Type', 'application/json');
             res.end(JSON.stringify({ error: 'File not found' }));
@@ -163,6 +534,15 @@ const requestHandler = async (req, res) => {
         // 是否需要 LUFS 扫描
         const scanLufs = parsedUrl.query.lufs === 'true';
 
+        // 进程级缓存：键包含文件 mtime，文件被替换后自动失效
+        const audioInfoKey = `${fullAudioPath}:${audioStats.mtimeMs}:${scanLufs}`;
+        const cachedAudioInfo = audioInfoMemCache.get(audioInfoKey);
+        if (cachedAudioInfo) {
+            res.setHeader('Content-Type', 'application/json');
+            res.end(cachedAudioInfo);
+            return;
+        }
+
         // 1. ffprobe 获取格式/流信息
         const ffprobePromise = new Promise((resolve) => {
             const ffprobe = spawn('ffprobe', [
@@ -239,7 +619,9 @@ const requestHandler = async (req, res) => {
                 result.lufs = lufs;
                 console.log(`[audio-info] ${path.basename(fullAudioPath)}: LUFS=${lufs}`);
             }
-            res.end(JSON.stringify(result));
+            const payload = JSON.stringify(result);
+            audioInfoMemCache.set(audioInfoKey, payload);
+            res.end(payload);
         });
         return;
     }
@@ -337,7 +719,7 @@ const requestHandler = async (req, res) => {
 
         const { source, 'no-write': noWrite, 'original-lyrics': originalLyrics, 'force-match': forceMatch, limit, only } = parsedUrl.query;
 
-        const args = [path.join(__dirname, 'get_music_info.py'), fullMusicPath, '--json-output'];
+        const args = [fullMusicPath, '--json-output'];
 
         if (source) {
             args.push('--source', source);
@@ -361,49 +743,150 @@ const requestHandler = async (req, res) => {
             args.push('--limit', limit);
         }
 
-        console.log(`[spawn] python ${args.join(' ')}`);
-        const pythonProcess = spawn('python', args, {
-            env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
-        });
-
-        let stdoutData = '';
-        let stderrData = '';
+        // 进程级缓存：相同参数的请求（多设备浏览同一目录）直接命中内存
+        const memCacheKey = args.join('\u0000');
+        const cachedPayload = musicInfoMemCache.get(memCacheKey);
+        if (cachedPayload) {
+            res.setHeader('Content-Type', 'application/json');
+            res.end(cachedPayload);
+            return;
+        }
 
-        pythonProcess.stdout.on('data', (data) => {
-            stdoutData += data.toString();
+        console.log(`[music-info pool] dispatch ${args.join(' ')}`);
+        dispatchMusicInfoRequest(args).then((response) => {
+            res.setHeader('Content-Type', 'application/json');
+            if (response.success && response.data) {
+                const payload = JSON.stringify({ success: true, data: response.data });
+                musicInfoMemCache.set(memCacheKey, payload);
+                res.end(payload);
+            } else if (response.success) {
+                // worker 正常返回但没有找到匹配项
+                res.end(JSON.stringify({ success: false, message: 'Could not find a good match.', data: null }));
+            } else {
+                console.error('[music-info pool] Worker error:', response.error);
+                res.statusCode = 500;
+                res.end(JSON.stringify({ success: false, message: 'Error getting music info' }));
+            }
+        }).catch((err) => {
+            console.error('[music-info pool] Dispatch failed:', err.message);
+            res.statusCode = 500;
+            res.end(JSON.stringify({ success: false, message: 'Error getting music info' }));
         });
+        return;
+    }
 
-        pythonProcess.stderr.on('data', (data) => {
-            stderrData += data.toString();
+    // 批量获取音乐元数据：整个播放列表一次请求解决
+    // 缓存命中通过 worker 池的 batch_db_lookup 一次性取回（单次 SQLite 连接），
+    // 未命中的文件逐个经由 worker 池解析，结果以 NDJSON 流式返回，
+    // 避免播放列表加载时间随曲目数线性增长。
+    if (pathname === '/api/music-info/batch' && req.method === 'POST') {
+        let body = '';
+        req.on('data', chunk => {
+            body += chunk.toString();
         });
-
-        pythonProcess.on('close', (code) => {
-            if (stderrData) {
-                console.error(`get_music_info.py stderr: ${stderrData}`);
+        req.on('end', async () => {
+            let payload;
+            try {
+                payload = JSON.parse(body);
+            } catch (e) {
+                res.statusCode = 400;
+                res.end(JSON.stringify({ success: false, message: 'Invalid JSON' }));
+                return;
             }
-            if (code !== 0) {
-                res.statusCode = 500;
-                res.end(JSON.stringify({ success: false, message: 'Error getting music info' }));
+
+            const { paths, mediaDir, source, resolveMisses } = payload;
+            if (!Array.isArray(paths) || paths.length === 0) {
+                res.statusCode = 400;
+                res.end(JSON.stringify({ success: false, message: 'Missing paths array' }));
                 return;
             }
+
+            // 与 /api/music-info 相同的 baseDir 解析逻辑
+            let baseDir;
+            if (mediaDir) {
+                const allowedMediaDir = MEDIA_DIRS.find(d => d.path === mediaDir);
+                baseDir = allowedMediaDir ? allowedMediaDir.path : mediaDir;
+            } else {
+                baseDir = MUSIC_DIR;
+            }
+
+            const fullPathByRelative = new Map();
+            for (const relativePath of paths) {
+                fullPathByRelative.set(relativePath, path.join(baseDir, relativePath));
+            }
+
+            res.setHeader('Content-Type', 'application/x-ndjson');
+            res.setHeader('Cache-Control', 'no-cache');
+            let aborted = false;
+            req.on('close', () => { aborted = true; });
+            const writeLine = (obj) => {
+                if (!aborted && !res.writableEnded) res.write(JSON.stringify(obj) + '\n');
+            };
+
+            let lookup;
             try {
-                // 尝试找到有效的JSON输出
-                const jsonMatch = stdoutData.match(/({[\s\S]*})/);
-                if (jsonMatch && jsonMatch[1]) {
-                    const musicInfo = JSON.parse(jsonMatch[1]);
-                    res.setHeader('Content-Type', 'application/json');
-                    res.end(JSON.stringify({ success: true, data: musicInfo }));
-                } else {
-                    // 如果没有找到JSON，说明Python脚本可能没有找到匹配项
-                    res.setHeader('Content-Type', 'application/json');
-                    res.end(JSON.stringify({ success: false, message: 'Could not find a good match.', data: null }));
+                lookup = await dispatchMusicInfoOp({
+                    op: 'batch_db_lookup',
+                    paths: Array.from(fullPathByRelative.values())
+                });
+            } catch (err) {
+                console.error('[music-info batch] DB lookup failed:', err.message);
+                writeLine({ type: 'error', message: 'Batch DB lookup failed' });
+                res.end();
+                return;
+            }
+
+            const found = (lookup.success && lookup.found) ? lookup.found : {};
+            const missingFull = new Set((lookup.success && lookup.missing) ? lookup.missing : Array.from(fullPathByRelative.values()));
+
+            // 1. 缓存命中：立即一次性写出
+            const missingRelative = [];
+            for (const [relativePath, fullPath] of fullPathByRelative) {
+                const cached = found[fullPath];
+                if (cached) {
+                    const data = { title: cached.title, artist: cached.artist, album: cached.album };
+                    if (cached.cover_path) {
+                        const coverFilename = path.basename(cached.cover_path);
+                        data.cover_filename = coverFilename;
+                        data.cover_url = `/cache/covers/${encodeURIComponent(coverFilename)}`;
+                    }
+                    writeLine({ type: 'cached', path: relativePath, success: true, data });
+                } else if (missingFull.has(fullPath)) {
+                    missingRelative.push(relativePath);
+                }
+            }
+
+            // 2. 缓存未命中：逐个经由 worker 池解析并流式返回
+            //    （并发由池大小限制，请求方关闭连接时停止继续派发）
+            if (resolveMisses !== false && missingRelative.length > 0) {
+                // 全部派发给 worker 池（并发由池大小限制），按完成顺序流式写出
+                await Promise.all(missingRelative.map(async (relativePath) => {
+                    if (aborted) return;
+                    const args = [fullPathByRelative.get(relativePath), '--json-output', '--no-write', '--write-db', '--only', 'info'];
+                    if (source) {
+                        args.push('--source', source);
+                    }
+                    try {
+                        const response = await dispatchMusicInfoRequest(args);
+                        if (aborted) return;
+                        if (response.success && response.data) {
+                            writeLine({ type: 'resolved', path: relativePath, success: true, data: response.data });
+                        } else {
+                            writeLine({ type: 'resolved', path: relativePath, success: false });
+                        }
+                    } catch (err) {
+                        console.error(`[music-info batch] Resolve failed for ${relativePath}:`, err.message);
+                        if (!aborted) writeLine({ type: 'resolved', path: relativePath, success: false });
+                    }
+                }));
+            } else {
+                for (const relativePath of missingRelative) {
+                    writeLine({ type: 'miss', path: relativePath, success: false });
                 }
-            } catch (e) {
-                console.error('Error parsing python script output:', e);
-                console.error('Raw stdout:', stdoutData);
-                res.statusCode = 500;
-                res.end(JSON.stringify({ success: false, message: 'Error parsing music info' }));
             }
+
+            writeLine({ type: 'done', total: paths.length, cached: paths.length - missingRelative.length });
+            res.end();
         });
         return;
     }
@@ -438,7 +921,6 @@ const requestHandler = async (req, res) => {
         const { 'original-lyrics': originalLyrics, 'force-match': forceMatch, limit, query, 'force-fetch': forceFetch } = parsedUrl.query;
 
         const args = [
-            path.join(__dirname, 'get_music_info.py'),
             fullMusicPath,
             '--source', source,
             // Always add --no-write for safety, and --write-db to save metadata
@@ -469,54 +951,30 @@ const requestHandler = async (req, res) => {
             args.push('--force-fetch');
         }
 
-        console.log(`[spawn] python ${args.join(' ')}`);
-        const pythonProcess = spawn('python', args, {
-            env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
-        });
-
-        let stdoutData = '';
-        let stderrData = '';
-
-        pythonProcess.stdout.on('data', (data) => {
-            stdoutData += data.toString();
-        });
+        console.log(`[music-info pool] dispatch ${args.join(' ')}`);
+        dispatchMusicInfoRequest(args).then((response) => {
+            res.setHeader('Content-Type', 'application/json');
+            if (response.success && response.data) {
+                const musicInfo = response.data;
 
-        pythonProcess.stderr.on('data', (data) => {
-            stderrData += data.toString();
-        });
+                // 如果有 cover_filename 但没有 cover_url，则生成 cover_url
+                if (musicInfo.cover_filename && !musicInfo.cover_url) {
+                    const safeCoverFilename = musicInfo.cover_filename.replace(/\\/g, '/').split('/').map(encodeURIComponent).join('/');
+                    musicInfo.cover_url = `/cache/covers/${safeCoverFilename}`;
+                }
 
-        pythonProcess.on('close', (code) => {
-            if (stderrData) {
-                console.error(`get_music_info.py stderr: ${stderrData}`);
-            }
-            if (code !== 0) {
+                res.end(JSON.stringify({ success: true, data: musicInfo }));
+            } else if (response.success) {
+                res.end(JSON.stringify({ success: false, message: 'Could not find a good match.', data: null }));
+            } else {
+                console.error('[music-info pool] Worker error:', response.error);
                 res.statusCode = 500;
                 res.end(JSON.stringify({ success: false, message: 'Error executing python script' }));
-                return;
-            }
-            try {
-                const jsonMatch = stdoutData.match(/({[\s\S]*})/);
-                if (jsonMatch && jsonMatch[1]) {
-                    const musicInfo = JSON.parse(jsonMatch[1]);
-                    
-                    // 如果有 cover_filename 但没有 cover_url，则生成 cover_url
-                    if (musicInfo.cover_filename && !musicInfo.cover_url) {
-                        const safeCoverFilename = musicInfo.cover_filename.replace(/\\/g, '/').split('/').map(encodeURIComponent).join('/');
-                        musicInfo.cover_url = `/cache/covers/${safeCoverFilename}`;
-                    }
-                    
-                    res.setHeader('Content-Type', 'application/json');
-                    res.end(JSON.stringify({ success: true, data: musicInfo }));
-                } else {
-                    res.setHeader('Content-Type', 'application/json');
-                    res.end(JSON.stringify({ success: false, message: 'Could not find a good match.', data: null }));
-                }
-            } catch (e) {
-                console.error('Error parsing python script output:', e);
-                console.error('Raw stdout:', stdoutData);
-                res.statusCode = 500;
-                res.end(JSON.stringify({ success: false, message: 'Error parsing music info' }));
             }
+        }).catch((err) => {
+            console.error('[music-info pool] Dispatch failed:', err.message);
+            res.statusCode = 500;
+            res.end(JSON.stringify({ success: false, message: 'Error executing python script' }));
         });
         return;
     }
@@ -763,6 +1221,24 @@ const requestHandler = async (req, res) => {
                 return;
             }
 
+            // 喂入库状态版本号（增量同步的变更源；stat 已经做了，零额外 I/O）
+            observeDirectoryState(currentMediaDir, targetPath, stats.mtimeMs);
+
+            // 流式分页模式：format=ndjson 时逐条输出（巨型目录不再等整个
+            // payload 构建完才开始传输），支持 offset/limit 与排序键
+            if (parsedUrl.query.format === 'ndjson') {
+                streamDirectoryListing(fullPath, parsedUrl.query, req, res);
+                return;
+            }
+
+            // 进程级缓存：目录 mtime 未变时直接命中（多设备同时浏览同一目录）
+            const cachedListing = listingMemCache.get(fullPath);
+            if (cachedListing && cachedListing.mtimeMs === stats.mtimeMs) {
+                res.setHeader('Content-Type', 'application/json');
+                res.end(cachedListing.payload);
+                return;
+            }
+
             res.setHeader('Content-Type', 'application/json');
             fs.readdir(fullPath, { withFileTypes: true }, (err, files) => {
                 if (err) {
@@ -810,7 +1286,9 @@ const requestHandler = async (req, res) => {
                 // 等待所有文件信息处理完成
                 Promise.all(filePromises)
                     .then(fileList => {
-                        res.end(JSON.stringify(fileList));
+                        const payload = JSON.stringify(fileList);
+                        listingMemCache.set(fullPath, { mtimeMs: stats.mtimeMs, payload });
+                        res.end(payload);
                     })
                     .catch(error => {
                         console.error('Error processing file list:', error);
@@ -886,7 +1364,12 @@ const requestHandler = async (req, res) => {
                 const isImage = ['.jpg', '.jpeg', '.png', '.gif', '.bmp', '.webp'].includes(extension);
 
                 if (isVideo) {
-                    generateVideoThumbnail(fullPath, thumbnailPath)
+                    // 客户端断开（磁贴滚出视野）后丢弃排队中的任务
+                    const cancelToken = { cancelled: false };
+                    res.on('close', () => {
+                        if (!res.writableEnded) cancelToken.cancelled = true;
+                    });
+                    generateVideoThumbnail(fullPath, thumbnailPath, cancelToken)
                         .then(() => {
                             const readStream = fs.createReadStream(thumbnailPath);
 
@@ -913,6 +1396,14 @@ const requestHandler = async (req, res) => {
                             }
                         })
                         .catch((error) => {
+                            if (error.message === 'Thumbnail generation cancelled') {
+                                // 请求方已离开或生成被停止；对仍在线的客户端返回 503 以免空 200 被当作图片缓存
+                                if (!res.writableEnded) {
+                                    if (!res.headersSent) res.statusCode = 503;
+                                    res.end();
+                                }
+                                return;
+                            }
                             console.error('Error generating video thumbnail:', error);
                             res.statusCode = 500;
                             res.end('Error generating thumbnail');
@@ -1003,62 +1494,19 @@ const requestHandler = async (req, res) => {
         const fullPath = path.join(requestedMediaDir, relativePath);
 
         try {
-            const files = await fs.promises.readdir(fullPath);
-            const coverNames = ['cover', 'folder', 'front', 'back'];
-            const imageExtensions = ['.jpg', '.jpeg', '.png', '.gif', '.bmp', '.webp'];
-            const videoExtensions = [
-                // 现代网络格式 (多数浏览器原生支持)
-                '.mp4', '.webm', '.ogv',
-                // Apple 格式
-                '.mov', '.m4v',
-                // 常见封装格式 (浏览器支持度不一，通常需要插件或转码)
-                '.avi', '.mkv', '.flv', '.f4v', '.wmv', '.asf',
-                // 高清/光盘/流格式
-                '.ts', '.mts', '.m2ts', '.vob', '.m2p',
-                // 移动端/老旧格式
-                '.3gp', '.3g2', '.rmvb', '.rm', '.mpg', '.mpeg', '.m1v', '.m4p',
-                // 专业级
-                '.mxf', '.dv'
-            ];
-
-            // 1. 查找专辑封面
-            for (const name of coverNames) {
-                for (const ext of imageExtensions) {
-                    const coverFile = name + ext;
-                    if (files.some(f => f.toLowerCase() === coverFile)) {
-                        const streamPath = path.join(fullPath, coverFile);
-                        const stream = fs.createReadStream(streamPath);
-
-                        // 监听客户端断开连接
-                        req.on('close', () => stream.destroy());
-                        req.on('error', () => stream.destroy());
-                        res.on('close', () => stream.destroy());
-                        res.on('error', () => stream.destroy());
-
-                        stream.on('error', (err) => {
-                            console.error(`Error streaming cover file ${streamPath}:`, err);
-                            if (!res.headersSent) {
-                                res.statusCode = 500;
-                                res.end('Error reading cover file.');
-                            }
-                            stream.destroy();
-                        });
-
-                        res.setHeader('Content-Type', getContentType(streamPath));
-                        if (!res.headersSent && !res.finished) {
-                            stream.pipe(res);
-                        } else {
-                            stream.destroy();
-                        }
-                        return;
-                    }
-                }
+            // O(1) 索引查询：目录 mtime 未变化时直接使用已记录的代表文件，
+            // 不再为每个可见文件夹做一次 readdir 扫描（NAS 上每次 100-400ms）
+            const stats = await fs.promises.stat(fullPath);
+            let entry = folderThumbIndex.get(fullPath);
+            if (!entry || entry.mtimeMs !== stats.mtimeMs) {
+                const rep = await findFolderRepresentative(fullPath);
+                entry = { type: rep.type, file: rep.file, mtimeMs: stats.mtimeMs, checkedAt: Date.now() };
+                folderThumbIndex.set(fullPath, entry);
+                scheduleFolderThumbIndexSave();
             }
 
-            // 2. 查找图片（优先于视频）
-            const firstImage = files.find(f => imageExtensions.includes(path.extname(f).toLowerCase()));
-            if (firstImage) {
-                const streamPath = path.join(fullPath, firstImage);
+            if (entry.type === 'image') {
+                const streamPath = path.join(fullPath, entry.file);
                 const stream = fs.createReadStream(streamPath);
 
                 // 监听客户端断开连接
@@ -1068,7 +1516,7 @@ const requestHandler = async (req, res) => {
                 res.on('error', () => stream.destroy());
 
                 stream.on('error', (err) => {
-                    console.error(`Error streaming first image ${streamPath}:`, err);
+                    console.error(`Error streaming folder image ${streamPath}:`, err);
                     if (!res.headersSent) {
                         res.statusCode = 500;
                         res.end('Error reading image file.');
@@ -1085,11 +1533,9 @@ const requestHandler = async (req, res) => {
                 return;
             }
 
-            // 3. 查找视频并生成缩略图
-            const firstVideo = files.find(f => videoExtensions.includes(path.extname(f).toLowerCase()));
-            if (firstVideo) {
+            if (entry.type === 'video') {
                 // Correctly join the path without adding extra slashes if relativePath is the root.
-                const videoPathForThumbnail = relativePath === '/' ? firstVideo : path.join(relativePath, firstVideo);
+                const videoPathForThumbnail = relativePath === '/' ? entry.file : path.join(relativePath, entry.file);
                 // 确保路径使用 /
                 const encodedVideoPath = videoPathForThumbnail.replace(/\\/g, '/').split('/').map(encodeURIComponent).join('/');
                 res.writeHead(302, { 'Location': `/thumbnail/${encodedVideoPath}?mediaDir=${encodeURIComponent(requestedMediaDir)}` });
@@ -1097,7 +1543,7 @@ const requestHandler = async (req, res) => {
                 return;
             }
 
-            // 4. 返回默认文件夹图标 (这里我们用一个不存在的路径来触发前端的onerror)
+            // 返回默认文件夹图标 (这里我们用一个不存在的路径来触发前端的onerror)
             res.statusCode = 404;
             res.end('No suitable thumbnail found');
 
@@ -1110,6 +1556,65 @@ const requestHandler = async (req, res) => {
         return;
     }
 
+    // 进度条雪碧图（hover-seek 预览）：一次 ffmpeg 解码产出
+    // 10x10 网格 + WebVTT storyboard（标准播放器用）+ 100x1 横条（DPlayer 用），
+    // 缓存在 THUMBNAIL_DIR，命中后拖动预览只是一次静态图片请求。
+    if (pathname === '/api/storyboard' && req.method === 'GET') {
+        const videoRelPath = parsedUrl.query.path;
+        const requestedMediaDir = parsedUrl.query.mediaDir || currentMediaDir;
+        if (!videoRelPath) {
+            res.statusCode = 400;
+            res.end(JSON.stringify({ success: false, message: 'Missing path parameter' }));
+            return;
+        }
+        const fullVideoPath = path.join(requestedMediaDir, videoRelPath);
+        if (!fs.existsSync(fullVideoPath)) {
+            res.statusCode = 404;
+            res.end(JSON.stringify({ success: false, message: 'Video not found' }));
+            return;
+        }
+
+        // 与 /thumbnail 相同的命名方式：md5(相对路径 + mediaDir)
+        const storyboardHash = crypto.createHash('md5').update(videoRelPath + requestedMediaDir).digest('hex');
+        const spritePath = path.join(THUMBNAIL_DIR, `${storyboardHash}_storyboard.jpg`);
+        const stripPath = path.join(THUMBNAIL_DIR, `${storyboardHash}_strip.jpg`);
+        const vttPath = path.join(THUMBNAIL_DIR, `${storyboardHash}_storyboard.vtt`);
+
+        const respondReady = () => {
+            res.setHeader('Content-Type', 'application/json');
+            res.end(JSON.stringify({
+                success: true,
+                sprite_url: `/cache/thumbnails/${storyboardHash}_storyboard.jpg`,
+                strip_url: `/cache/thumbnails/${storyboardHash}_strip.jpg`,
+                vtt_url: `/cache/thumbnails/${storyboardHash}_storyboard.vtt`
+            }));
+        };
+
+        if (fs.existsSync(vttPath) && fs.existsSync(stripPath)) {
+            respondReady();
+            return;
+        }
+
+        // 未缓存：经缩略图队列排队生成（与磁贴缩略图共享并发上限，按输出路径去重）
+        const generation = queueThumbnailGeneration(
+            () => generateStoryboard(fullVideoPath, spritePath, stripPath, vttPath),
+            spritePath
+        );
+        if (parsedUrl.query.wait === 'true') {
+            generation.then(respondReady).catch((err) => {
+                console.error('[storyboard] Generation failed:', err.message);
+                res.statusCode = 500;
+                res.end(JSON.stringify({ success: false, message: 'Storyboard generation failed' }));
+            });
+        } else {
+            // 异步生成：立即返回 202，下次播放命中缓存
+            generation.catch((err) => console.error('[storyboard] Generation failed:', err.message));
+            res.statusCode = 202;
+            res.end(JSON.stringify({ success: false, generating: true }));
+        }
+        return;
+    }
+
     // 处理停止缩略图生成请求
     if (pathname === '/api/stop-thumbnail-generation' && req.method === 'POST') {
         stopAllThumbnailGenerations();
@@ -1172,8 +1677,13 @@ const requestHandler = async (req, res) => {
             return;
         }
 
-        // 调用搜索功能
-        performSearch(query, maxResults, matchCase, matchWholeWord, useRegex, parsedUrl.query.dirs) // 传递 dirs 参数
+        // 调用搜索功能（分页与排序下推给 Everything）
+        const paging = {
+            offset: parseInt(parsedUrl.query.offset) || 0,
+            sort: ['name', 'size', 'date-modified'].includes(parsedUrl.query.sort) ? parsedUrl.query.sort : null,
+            order: parsedUrl.query.order === 'desc' ? 'desc' : 'asc'
+        };
+        performSearch(query, maxResults, matchCase, matchWholeWord, useRegex, parsedUrl.query.dirs, paging) // 传递 dirs 参数
             .then(searchResults => {
                 //console.log('Search completed successfully, results count:', searchResults.results ? searchResults.results.length : 0);
                 res.statusCode = 200;
@@ -1350,15 +1860,18 @@ const requestHandler = async (req, res) => {
         const targetPath = parsedUrl.query.path || '';
         const sortOrder = parsedUrl.query.order || 'asc';
         const useSystemTime = parsedUrl.query.system === 'true';
+        const wantStream = parsedUrl.query.stream === 'true';
         const fullPath = path.join(currentMediaDir, targetPath);
 
         const args = [
             path.join(__dirname, 'concurrent-time-sort.py'),
             '-path', fullPath,
-            '-s', sortOrder,
-            '-j'
+            '-s', sortOrder
         ];
 
+        // 流式模式：冷缓存下先返回临时排序，真实 mtime 到齐后逐步修正
+        args.push(wantStream ? '-stream' : '-j');
+
         if (useSystemTime) {
             args.push('-f');
         }
@@ -1367,6 +1880,66 @@ const requestHandler = async (req, res) => {
             env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
         });
 
+        if (wantStream) {
+            res.setHeader('Content-Type', 'application/x-ndjson');
+            res.setHeader('Cache-Control', 'no-cache');
+            let aborted = false;
+            req.on('close', () => {
+                aborted = true;
+                try { pythonProcess.kill('SIGTERM'); } catch (e) { }
+            });
+
+            const sizeByName = new Map(); // 条目大小只 stat 一次，后续 reorder 直接复用
+            const toFileList = (pythonItems) => pythonItems.map(item => {
+                const name = path.basename(item.path);
+                const isDirectory = item.item_type === 'folder';
+                let size = 0;
+                if (!isDirectory) {
+                    if (sizeByName.has(name)) {
+                        size = sizeByName.get(name);
+                    } else {
+                        try { size = fs.statSync(item.path).size; } catch (e) { }
+                        sizeByName.set(name, size);
+                    }
+                }
+                return { name, isDirectory, size };
+            });
+
+            let buffer = '';
+            pythonProcess.stdout.on('data', (data) => {
+                buffer += data.toString();
+                let newlineIdx;
+                while ((newlineIdx = buffer.indexOf('\n')) !== -1) {
+                    const line = buffer.slice(0, newlineIdx).trim();
+                    buffer = buffer.slice(newlineIdx + 1);
+                    if (!line || aborted || res.writableEnded) continue;
+                    let msg;
+                    try {
+                        msg = JSON.parse(line);
+                    } catch (e) {
+                        continue;
+                    }
+                    if (msg.items) {
+                        res.write(JSON.stringify({ type: msg.type, pending: msg.pending, files: toFileList(msg.items) }) + '\n');
+                    } else {
+                        res.write(JSON.stringify(msg) + '\n');
+                    }
+                }
+            });
+            pythonProcess.stderr.on('data', (data) => {
+                const msg = data.toString().trim();
+                if (msg) console.error(`concurrent-time-sort.py stderr: ${msg}`);
+            });
+            pythonProcess.on('close', () => {
+                if (!res.writableEnded) res.end();
+            });
+            pythonProcess.on('error', (err) => {
+                console.error('[sort-by-time] Failed to start python:', err.message);
+                if (!res.writableEnded) res.end();
+            });
+            return;
+        }
+
         let stdoutData = '';
         let stderrData = '';
 
@@ -2412,7 +2985,80 @@ const requestHandler = async (req, res) => {
     }
 
     // API to get cache info
+    // 性能指标：端点延迟直方图、子进程统计、缩略图队列与缓存命中率
+    if (pathname === '/api/perf' && req.method === 'GET') {
+        const extra = {
+            thumbnail_queue_depth: thumbnailQueue.length,
+            thumbnail_active_generations: activeGenerations,
+            memory_cache: memCache.stats()
+        };
+        if (parsedUrl.query.format === 'prometheus') {
+            res.setHeader('Content-Type', 'text/plain; version=0.0.4');
+            res.end(perf.toPrometheus({
+                thumbnail_queue_depth: thumbnailQueue.length,
+                thumbnail_active_generations: activeGenerations
+            }));
+        } else {
+            res.setHeader('Content-Type', 'application/json');
+            res.end(JSON.stringify(perf.snapshot(extra)));
+        }
+        return;
+    }
+
+    // 增量同步：自 since 版本以来发生变化的目录（客户端据此决定重取哪些列表）
+    if (pathname === '/api/library-delta' && req.method === 'GET') {
+        const rootPath = parsedUrl.query.mediaDir || currentMediaDir;
+        const state = libraryStateFor(rootPath);
+
+        // since 形如 "<启动纪元>-<计数>"；纪元不是本次进程的 → 全量重同步
+        const sinceParam = String(parsedUrl.query.since || '');
+        const dashIdx = sinceParam.indexOf('-');
+        const sinceEpoch = dashIdx > 0 ? sinceParam.slice(0, dashIdx) : '';
+        const since = dashIdx > 0 ? (parseInt(sinceParam.slice(dashIdx + 1), 10) || 0) : 0;
+        const epochMatches = sinceEpoch === String(LIBRARY_BOOT_EPOCH);
+
+        // 客户端关心的目录即刻 stat 一次（一次系统调用），
+        // 即使没有任何客户端重新列出过该目录，它的变更也能进入本次增量
+        const probePath = parsedUrl.query.path;
+        if (probePath) {
+            try {
+                const probeStats = fs.statSync(path.join(rootPath, probePath));
+                if (probeStats.isDirectory()) {
+                    observeDirectoryState(rootPath, probePath === '/' ? '' : probePath, probeStats.mtimeMs);
+                }
+            } catch (e) { /* 目录消失：留给列表请求报 404 */ }
+        }
+
+        res.setHeader('Content-Type', 'application/json');
+        // since 无效（纪元不符 / 0 / 超前于服务端 / 早于变更日志窗口）：全量重同步
+        const oldestCovered = state.changes.length > 0 ? state.changes[0].version - 1 : state.version;
+        if (!epochMatches || since <= 0 || since > state.version || since < oldestCovered) {
+            res.end(JSON.stringify({ version: libraryVersionTag(state), full_resync: true }));
+            return;
+        }
+        const changedPaths = [...new Set(
+            state.changes.filter(c => c.version > since).map(c => c.path)
+        )];
+        res.end(JSON.stringify({ version: libraryVersionTag(state), full_resync: false, changed_paths: changedPaths }));
+        return;
+    }
+
+    // 进程内缓存的命中/未命中统计（验证缓存在负载下是否生效）
+    if (pathname === '/api/memory-cache-stats' && req.method === 'GET') {
+        res.setHeader('Content-Type', 'application/json');
+        res.end(JSON.stringify(memCache.stats()));
+        return;
+    }
+
     if (pathname === '/api/cache-info' && req.method === 'GET') {
+        // 进程级缓存：目录大小统计较贵，短 TTL 内直接复用
+        const cachedCacheInfo = cacheInfoMemCache.get('cache-info');
+        if (cachedCacheInfo) {
+            res.setHeader('Content-Type', 'application/json');
+            res.end(cachedCacheInfo);
+            return;
+        }
+
         const dirSizePromises = CACHE_SUB_DIRS.map(async (dir) => {
             const dirPath = path.join(CACHE_DIR, dir);
             const size = await getDirectorySize(dirPath);
@@ -2445,7 +3091,9 @@ const requestHandler = async (req, res) => {
             const allSizes = [...dirSizes, ...fileSizes];
             const totalSize = allSizes.reduce((acc, curr) => acc + curr.size, 0);
             res.setHeader('Content-Type', 'application/json');
-            res.end(JSON.stringify({ success: true, cacheSizes: allSizes, totalSize }));
+            const payload = JSON.stringify({ success: true, cacheSizes: allSizes, totalSize });
+            cacheInfoMemCache.set('cache-info', payload);
+            res.end(payload);
         } catch (error) {
             console.error('Error getting cache info:', error);
             res.statusCode = 500;
@@ -2462,6 +3110,8 @@ const requestHandler = async (req, res) => {
             try {
                 const { item } = JSON.parse(body);
                 const targetPath = path.join(CACHE_DIR, item);
+                // 磁盘缓存变化后，内存中的统计立即失效
+                cacheInfoMemCache.delete('cache-info');
                 if (!fs.existsSync(targetPath)) {
                     res.statusCode = 200;
                     res.end(JSON.stringify({ success: true, message: `Cache item '${item}' was already empty or deleted.` }));
@@ -2505,9 +3155,9 @@ const requestHandler = async (req, res) => {
         req.on('end', () => {
             try {
                 const { method, title, imdb_id } = JSON.parse(body);
-                if (!method || !title) {
+                if (!title) {
                     res.statusCode = 400;
-                    res.end(JSON.stringify({ success: false, message: 'Missing method or title' }));
+                    res.end(JSON.stringify({ success: false, message: 'Missing title' }));
                     return;
                 }
                 if (method === 'subliminal' && !imdb_id) {
@@ -2516,6 +3166,36 @@ const requestHandler = async (req, res) => {
                     return;
                 }
 
+                // 未指定提供方：并发向所有提供方 fan-out，第一个可用结果获胜
+                // （命中解析缓存时直接跳过搜索阶段）
+                if (!method) {
+                    const searchAllArgs = [path.join(__dirname, 'download_subtitle.py'), '--action', 'search-all', '--title', title];
+                    if (imdb_id) searchAllArgs.push('--imdb_id', imdb_id);
+                    const searchProcess = spawn('python', searchAllArgs, {
+                        env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
+                    });
+                    let searchStdout = '';
+                    let searchStderr = '';
+                    searchProcess.stdout.on('data', d => { searchStdout += d.toString(); });
+                    searchProcess.stderr.on('data', d => { searchStderr += d.toString(); });
+                    searchProcess.on('close', (code) => {
+                        res.setHeader('Content-Type', 'application/json');
+                        if (code !== 0) {
+                            res.statusCode = 500;
+                            res.end(JSON.stringify({ success: false, message: `search-all exited with code ${code}`, details: searchStderr }));
+                            return;
+                        }
+                        try {
+                            const jsonMatch = searchStdout.match(/({[\s\S]*})/);
+                            res.end(jsonMatch ? jsonMatch[1] : JSON.stringify({ success: false, message: 'No output from search-all' }));
+                        } catch (e) {
+                            res.statusCode = 500;
+                            res.end(JSON.stringify({ success: false, message: 'Failed to parse search-all output', output: searchStdout }));
+                        }
+                    });
+                    return;
+                }
+
                 const args = [path.join(__dirname, 'download_subtitle.py'), '--site', method, '--title', title];
                 if (method === 'subliminal') {
                     args.push('--imdb_id', imdb_id);
@@ -2566,6 +3246,112 @@ const requestHandler = async (req, res) => {
         return;
     }
 
+    // 批量字幕猎取：整个目录缺字幕的视频经一个 --batch-stdin 进程处理
+    // （共享会话池 + 解析缓存 + 提供方并发 fan-out），进度经 WebSocket 广播
+    if (pathname === '/api/download-subtitles-directory' && req.method === 'POST') {
+        let body = '';
+        req.on('data', chunk => { body += chunk.toString(); });
+        req.on('end', async () => {
+            try {
+                const { path: relativePath, mediaDir } = JSON.parse(body);
+                if (!relativePath || !mediaDir) {
+                    res.statusCode = 400;
+                    res.end(JSON.stringify({ success: false, message: 'Missing path or mediaDir' }));
+                    return;
+                }
+                const fullPath = path.join(mediaDir, relativePath);
+
+                res.statusCode = 200;
+                res.setHeader('Content-Type', 'application/json');
+                res.end(JSON.stringify({ success: true, message: 'Subtitle batch started.' }));
+
+                (async () => {
+                    try {
+                        const videoFiles = await findVideoFilesRecursively(fullPath);
+                        console.log(`[SubtitleBatch] Found ${videoFiles.length} video files in ${fullPath}`);
+
+                        // 只处理还没有字幕的文件
+                        const missing = [];
+                        for (const filePath of videoFiles) {
+                            try {
+                                const subtitleResult = await findSubtitles(filePath, mediaDir, false, true);
+                                if (subtitleResult && subtitleResult.subtitles && subtitleResult.subtitles.length > 0) {
+                                    continue;
+                                }
+                            } catch (e) { /* 检查失败按缺字幕处理 */ }
+                            missing.push(filePath);
+                        }
+                        console.log(`[SubtitleBatch] ${missing.length} files missing subtitles`);
+                        broadcast({
+                            type: 'subtitle_batch_start',
+                            files: missing.map(f => ({ name: path.basename(f) }))
+                        });
+                        if (missing.length === 0) {
+                            broadcast({ type: 'subtitle_batch_finished', found: 0, total: 0 });
+                            return;
+                        }
+
+                        const batchProcess = spawn('python', [path.join(__dirname, 'download_subtitle.py'), '--batch-stdin'], {
+                            env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
+                        });
+                        for (const filePath of missing) {
+                            const title = path.basename(filePath, path.extname(filePath));
+                            batchProcess.stdin.write(JSON.stringify({ title }) + '\n');
+                        }
+                        batchProcess.stdin.end();
+
+                        let buffer = '';
+                        let foundCount = 0;
+                        batchProcess.stdout.on('data', (data) => {
+                            buffer += data.toString();
+                            let newlineIdx;
+                            while ((newlineIdx = buffer.indexOf('\n')) !== -1) {
+                                const line = buffer.slice(0, newlineIdx).trim();
+                                buffer = buffer.slice(newlineIdx + 1);
+                                if (!line) continue;
+                                let result;
+                                try {
+                                    result = JSON.parse(line);
+                                } catch (e) {
+                                    continue;
+                                }
+                                if (result.success) foundCount++;
+                                broadcast({
+                                    type: 'subtitle_batch_progress',
+                                    title: result.title,
+                                    success: !!result.success,
+                                    provider: result.provider || null,
+                                    cached: !!result.cached
+                                });
+                            }
+                        });
+                        batchProcess.stderr.on('data', (data) => {
+                            const msg = data.toString().trim();
+                            if (msg) console.error(`[SubtitleBatch] ${msg}`);
+                        });
+                        batchProcess.on('close', (code) => {
+                            console.log(`[SubtitleBatch] Finished (code ${code}), found ${foundCount}/${missing.length}`);
+                            broadcast({ type: 'subtitle_batch_finished', found: foundCount, total: missing.length });
+                        });
+                        batchProcess.on('error', (err) => {
+                            console.error('[SubtitleBatch] Failed to start batch process:', err.message);
+                            broadcast({ type: 'subtitle_batch_finished', found: 0, total: missing.length, error: err.message });
+                        });
+                    } catch (bgError) {
+                        console.error('[SubtitleBatch] Background task error:', bgError);
+                        broadcast({ type: 'subtitle_batch_finished', found: 0, total: 0, error: bgError.message });
+                    }
+                })();
+            } catch (e) {
+                if (!res.headersSent) {
+                    res.statusCode = 400;
+                    res.end(JSON.stringify({ success: false, message: 'Invalid JSON request.' }));
+                }
+            }
+        });
+        return;
+    }
+
 
     // Subtitle download API
     if (pathname.startsWith('/api/subtitle/') && req.method === 'POST') {
@@ -2636,6 +3422,38 @@ const requestHandler = async (req, res) => {
     if (pathname === '/api/semantic-search' && req.method === 'GET') {
         const { vtt_file, query, mediaDir, ...otherParams } = parsedUrl.query;
 
+        // 库级搜索：scope=library 时跨所有已缓存字幕执行 ANN 搜索，无需 vtt_file
+        if (parsedUrl.query.scope === 'library') {
+            if (!query) {
+                res.statusCode = 400;
+                res.end(JSON.stringify({ error: "Missing 'query' parameter" }));
+                return;
+            }
+            const forwardParams = new URLSearchParams({ query });
+            if (parsedUrl.query.top_k) forwardParams.append('top_k', parsedUrl.query.top_k);
+            if (parsedUrl.query.min_score) forwardParams.append('min_score', parsedUrl.query.min_score);
+
+            const pythonServiceUrl = `http://127.0.0.1:5000/search_library?${forwardParams.toString()}`;
+            console.log(`[Semantic Search] Library-wide search, forwarding to: ${pythonServiceUrl}`);
+
+            http.get(pythonServiceUrl, (proxyRes) => {
+                let data = '';
+                proxyRes.on('data', (chunk) => {
+                    data += chunk;
+                });
+                proxyRes.on('end', () => {
+                    res.setHeader('Content-Type', 'application/json');
+                    res.statusCode = proxyRes.statusCode;
+                    res.end(data);
+                });
+            }).on('error', (err) => {
+                console.error('Error forwarding request to Python service:', err);
+                res.statusCode = 502; // Bad Gateway
+                res.end(JSON.stringify({ error: 'Failed to connect to the semantic search service.' }));
+            });
+            return;
+        }
+
         if (!vtt_file || !query || !mediaDir) {
             res.statusCode = 400;
             res.end(JSON.stringify({ error: "Missing 'vtt_file', 'query', or 'mediaDir' parameter" }));
@@ -2738,6 +3556,18 @@ const requestHandler = async (req, res) => {
         return;
     }
 
+    // 代理 /api/library-index/refresh（增量重建库级语义索引）
+    if (pathname === '/api/library-index/refresh' && req.method === 'POST') {
+        proxyRequestToPython(req, res, 5000, '/api/library_index/refresh');
+        return;
+    }
+
+    // 代理 /api/readiness（Python 后端各组件的就绪状态）
+    if (pathname === '/api/readiness' && req.method === 'GET') {
+        proxyRequestToPython(req, res, 5000, '/api/readiness');
+        return;
+    }
+
     // 代理 /api/chat
     if (pathname === '/api/chat' && req.method === 'POST') {
         proxyRequestToPython(req, res, 5000, '/api/chat');
@@ -2813,54 +3643,90 @@ const requestHandler = async (req, res) => {
                         console.log(`[VideoScraper] Broadcasting scrape_start with ${fileTasks.length} files`);
                         broadcast({ type: 'scrape_start', files: fileTasks.map(f => ({ id: f.id, name: f.name })) });
 
-                        for (const fileTask of fileTasks) {
-                            console.log(`[VideoScraper] Processing file: ${fileTask.name}`);
-                            const activeTaskFile = global.activeVideoScrapeTask.files.find(f => f.id === fileTask.id);
-                            if (activeTaskFile) activeTaskFile.status = 'scraping';
-                            broadcast({ type: 'scrape_progress', file: { id: fileTask.id, name: fileTask.name } });
-
-                            const result = await new Promise((resolve) => {
-                                const args = [path.join(__dirname, 'video_scraper.py'), fileTask.path, videoType, '--skip-existing'];
-                                const pythonProcess = spawn('python', args, {
-                                    env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
-                                });
-                                let stdoutData = '';
-                                let stderrData = '';
-                                pythonProcess.stdout.on('data', (data) => { stdoutData += data.toString(); });
-                                pythonProcess.stderr.on('data', (data) => { stderrData += data.toString(); });
-                                pythonProcess.on('close', (code) => {
-                                    if (stderrData) { console.error(`[Scraper] Stderr for ${fileTask.name}: ${stderrData}`); }
-                                    if (code !== 0) {
-                                        resolve({ success: false, error: `脚本错误 (code ${code})`, details: stderrData });
-                                    } else {
-                                        try {
-                                            const jsonMatch = stdoutData.match(/({[\s\S]*})/);
-                                            if (jsonMatch && jsonMatch[1]) {
-                                                const scrapedData = JSON.parse(jsonMatch[1]);
-                                                if (scrapedData.skipped) {
-                                                    resolve({ success: true, skipped: true });
-                                                } else if (scrapedData.error || (scrapedData.hasOwnProperty('jav_results') && !scrapedData.jav_results)) {
-                                                    resolve({ success: false, error: scrapedData.error || '未找到结果', details: JSON.stringify(scrapedData) });
-                                                } else {
-                                                    resolve({ success: true, data: scrapedData });
-                                                }
-                                            } else {
-                                                resolve({ success: false, error: '无法解析输出', details: stdoutData });
-                                            }
-                                        } catch (e) {
-                                            resolve({ success: false, error: '解析JSON失败', details: stdoutData });
-                                        }
-                                    }
-                                });
+                        // 单个批量进程处理整个目录：解释器只冷启动一次，
+                        // 标题间的网络等待由脚本内的线程池流水线重叠，
+                        // 对各来源的压力由脚本内的每域名限速控制。
+                        const taskByPath = new Map(fileTasks.map(f => [f.path, f]));
+                        await new Promise((resolve) => {
+                            const args = [path.join(__dirname, 'video_scraper.py'), '--batch-stdin'];
+                            if (videoType) args.push(videoType);
+                            args.push('--skip-existing');
+                            const pythonProcess = spawn('python', args, {
+                                env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
                             });
 
-                            console.log(`[VideoScraper] Finished file: ${fileTask.name}, success: ${result.success}`);
-                            if (activeTaskFile) {
-                                activeTaskFile.status = 'complete';
-                                activeTaskFile.result = result;
+                            // 所有文件都已提交给批量进程，标记为刮削中
+                            for (const fileTask of fileTasks) {
+                                const activeTaskFile = global.activeVideoScrapeTask.files.find(f => f.id === fileTask.id);
+                                if (activeTaskFile) activeTaskFile.status = 'scraping';
+                                broadcast({ type: 'scrape_progress', file: { id: fileTask.id, name: fileTask.name } });
                             }
-                            broadcast({ type: 'scrape_complete', file: { id: fileTask.id, name: fileTask.name }, result });
-                        }
+                            pythonProcess.stdin.write(fileTasks.map(f => f.path).join('\n') + '\n');
+                            pythonProcess.stdin.end();
+
+                            // 逐行读取 NDJSON 进度，按完成顺序广播
+                            let buffer = '';
+                            const handleLine = (line) => {
+                                let progress;
+                                try {
+                                    progress = JSON.parse(line);
+                                } catch (e) {
+                                    console.error('[VideoScraper] Failed to parse batch output line:', line);
+                                    return;
+                                }
+                                const fileTask = taskByPath.get(progress.path);
+                                if (!fileTask) return;
+
+                                let result;
+                                if (progress.status === 'skipped') {
+                                    result = { success: true, skipped: true };
+                                } else if (progress.status === 'ok' && progress.data) {
+                                    result = { success: true, data: progress.data };
+                                } else {
+                                    const scrapedData = progress.data || {};
+                                    result = { success: false, error: scrapedData.error || '未找到结果', details: JSON.stringify(scrapedData) };
+                                }
+
+                                console.log(`[VideoScraper] Finished file: ${fileTask.name}, success: ${result.success}`);
+                                const activeTaskFile = global.activeVideoScrapeTask.files.find(f => f.id === fileTask.id);
+                                if (activeTaskFile) {
+                                    activeTaskFile.status = 'complete';
+                                    activeTaskFile.result = result;
+                                }
+                                taskByPath.delete(progress.path);
+                                broadcast({ type: 'scrape_complete', file: { id: fileTask.id, name: fileTask.name }, result });
+                            };
+                            pythonProcess.stdout.on('data', (data) => {
+                                buffer += data.toString();
+                                let newlineIdx;
+                                while ((newlineIdx = buffer.indexOf('\n')) !== -1) {
+                                    const line = buffer.slice(0, newlineIdx).trim();
+                                    buffer = buffer.slice(newlineIdx + 1);
+                                    if (line) handleLine(line);
+                                }
+                            });
+                            pythonProcess.stderr.on('data', (data) => {
+                                const msg = data.toString().trim();
+                                if (msg) console.error(`[Scraper] ${msg}`);
+                            });
+                            pythonProcess.on('close', (code) => {
+                                // 批量进程异常退出：没有收到结果的文件标记为失败
+                                for (const [, fileTask] of taskByPath) {
+                                    const result = { success: false, error: `脚本错误 (code ${code})` };
+                                    const activeTaskFile = global.activeVideoScrapeTask.files.find(f => f.id === fileTask.id);
+                                    if (activeTaskFile) {
+                                        activeTaskFile.status = 'complete';
+                                        activeTaskFile.result = result;
+                                    }
+                                    broadcast({ type: 'scrape_complete', file: { id: fileTask.id, name: fileTask.name }, result });
+                                }
+                                resolve();
+                            });
+                            pythonProcess.on('error', (err) => {
+                                console.error('[VideoScraper] Failed to start batch scraper:', err.message);
+                                resolve();
+                            });
+                        });
                         console.log(`[VideoScraper] All tasks finished`);
                         if (global.activeVideoScrapeTask) global.activeVideoScrapeTask.isFinished = true;
                         broadcast({ type: 'scrape_finished_all' });
@@ -3037,7 +3903,22 @@ const requestHandler = async (req, res) => {
 
                         broadcast({ type: 'transcribe_start', files: fileTasks.map(f => ({ id: f.id, name: f.name })) });
 
-                        for (const fileTask of fileTasks) {
+                        // 流水线：GPU 转录第 N 个文件时，后端已在用 CPU 预处理第 N+1 个
+                        let nextPreprocess = { path: null, promise: null };
+                        const discardPreparedAudio = (fileTask) => {
+                            // 预处理了但该文件被跳过：清理孤立的临时音频
+                            if (nextPreprocess.path === fileTask.path && nextPreprocess.promise) {
+                                nextPreprocess.promise.then(prepared => {
+                                    if (prepared && prepared !== fileTask.path) {
+                                        fs.unlink(prepared, () => { });
+                                    }
+                                });
+                                nextPreprocess = { path: null, promise: null };
+                            }
+                        };
+
+                        for (let taskIndex = 0; taskIndex < fileTasks.length; taskIndex++) {
+                            const fileTask = fileTasks[taskIndex];
                             const activeTaskFile = global.activeTranscriptionTask.files.find(f => f.id === fileTask.id);
 
                             // 检查文件是否已有字幕或歌词，有则跳过
@@ -3065,6 +3946,7 @@ const requestHandler = async (req, res) => {
 
                             if (hasSubtitles) {
                                 console.log(`[Transcribe] Skipping ${fileTask.name} (subtitles/lyrics already exist)`);
+                                discardPreparedAudio(fileTask);
                                 if (activeTaskFile) {
                                     activeTaskFile.status = 'skipped';
                                     activeTaskFile.result = { success: true, skipped: true };
@@ -3126,10 +4008,23 @@ const requestHandler = async (req, res) => {
                             
                             startProgressMonitorAfterDelay();
 
+                            // 取用上一轮为本文件预处理好的音频（如果有）
+                            let preprocessedAudioPath = null;
+                            if (nextPreprocess.path === fileTask.path && nextPreprocess.promise) {
+                                preprocessedAudioPath = await nextPreprocess.promise;
+                                nextPreprocess = { path: null, promise: null };
+                            }
+                            // 启动下一个文件的预处理，与本文件的 GPU 转录并行
+                            const nextTask = fileTasks[taskIndex + 1];
+                            if (nextTask) {
+                                nextPreprocess = { path: nextTask.path, promise: requestAudioPreprocess(nextTask.path) };
+                            }
+
                             const result = await transcribeFileWithFallback(fileTask.path, {
                                 model: model || 'large-v3',
                                 modelSource: modelSource || 'pretrained',
-                                language, task: transcribeTask, vadFilter, denseSubtitles, maxCharsPerLine
+                                language, task: transcribeTask, vadFilter, denseSubtitles, maxCharsPerLine,
+                                preprocessedAudioPath
                             });
 
                             // 清理进度监测定时器
@@ -3225,7 +4120,7 @@ const requestHandler = async (req, res) => {
                     res.setHeader('Content-Length', chunksize);
                     res.setHeader('Content-Type', contentType);
 
-                    const stream = fs.createReadStream(fullMusicPath, { start, end, highWaterMark: 256 * 1024 });
+                    const stream = fs.createReadStream(fullMusicPath, { start, end, highWaterMark: MEDIA_STREAM_HIGH_WATER });
 
                     let streamCleaned = false;
                     const cleanupStream = () => {
@@ -3264,7 +4159,7 @@ const requestHandler = async (req, res) => {
                     res.setHeader('Content-Type', contentType);
                     res.setHeader('Accept-Ranges', 'bytes');
 
-                    const stream = fs.createReadStream(fullMusicPath, { highWaterMark: 256 * 1024 });
+                    const stream = fs.createReadStream(fullMusicPath, { highWaterMark: MEDIA_STREAM_HIGH_WATER });
 
                     let streamCleaned = false;
                     const cleanupStream = () => {
@@ -3409,12 +4304,41 @@ const requestHandler = async (req, res) => {
             const contentType = getContentType(resolvedPath);
             res.setHeader('Access-Control-Allow-Origin', '*'); // 允许跨域访问
 
-            if (range) {
+            // 条件请求支持：ETag（size+mtime）与 Last-Modified。
+            // 客户端重访时以 304 收场，多 GB 的媒体文件不再重复传输。
+            const etag = `"${stats.size.toString(16)}-${Math.floor(stats.mtimeMs).toString(16)}"`;
+            const lastModified = new Date(stats.mtimeMs).toUTCString();
+            res.setHeader('ETag', etag);
+            res.setHeader('Last-Modified', lastModified);
+            res.setHeader('Cache-Control', 'public, max-age=0, must-revalidate');
+
+            if (!range) {
+                const ifNoneMatch = req.headers['if-none-match'];
+                const ifModifiedSince = req.headers['if-modified-since'];
+                if (ifNoneMatch === etag || (!ifNoneMatch && ifModifiedSince === lastModified)) {
+                    res.statusCode = 304;
+                    res.end();
+                    return;
+                }
+            }
+
+            // If-Range：校验值与当前资源不符说明文件已变化，退回完整响应
+            let useRange = !!range;
+            if (useRange) {
+                const ifRange = req.headers['if-range'];
+                if (ifRange && ifRange !== etag && ifRange !== lastModified) {
+                    useRange = false;
+                }
+            }
+
+            if (useRange) {
                 // 视频流 (处理 Range 头)
                 const positions = range.replace(/bytes=/, "").split("-");
                 const start = parseInt(positions[0], 10);
                 const total = stats.size;
-                const end = positions[1] ? parseInt(positions[1], 10) : total - 1;
+                // 请求的结束字节需按文件大小截断，否则 Content-Length 与实际
+                // 流出的字节数不符，客户端会等到超时
+                const end = positions[1] ? Math.min(parseInt(positions[1], 10), total - 1) : total - 1;
 
                 if (start >= total) {
                     res.statusCode = 416;
@@ -3431,7 +4355,7 @@ const requestHandler = async (req, res) => {
                 res.setHeader('Content-Length', chunksize);
                 res.setHeader('Content-Type', contentType);
 
-                const stream = fs.createReadStream(resolvedPath, { start, end, highWaterMark: 256 * 1024 });
+                const stream = fs.createReadStream(resolvedPath, { start, end, highWaterMark: MEDIA_STREAM_HIGH_WATER });
 
                 let streamCleaned = false;
 
@@ -3488,7 +4412,7 @@ const requestHandler = async (req, res) => {
                 // 对于下载，可以添加 Content-Disposition
                 // res.setHeader('Content-Disposition', `attachment; filename="${path.basename(resolvedPath)}"`);
 
-                const readStream = fs.createReadStream(resolvedPath, { highWaterMark: 256 * 1024 });
+                const readStream = fs.createReadStream(resolvedPath, { highWaterMark: MEDIA_STREAM_HIGH_WATER });
 
                 let readStreamCleaned = false;
 
@@ -3550,14 +4474,14 @@ let server;
         if (fs.existsSync(httpsKeyPath) && fs.existsSync(httpsCertPath)) {
             const key = fs.readFileSync(httpsKeyPath);
             const cert = fs.readFileSync(httpsCertPath);
-            server = https.createServer({ key, cert }, requestHandler);
+            server = https.createServer({ key, cert }, instrumentedHandler);
             console.log('HTTPS enabled using', httpsKeyPath, httpsCertPath);
         }
     } catch (e) {
         console.warn('HTTPS setup error:', e && e.message);
     }
     if (!server) {
-        server = http.createServer(requestHandler);
+        server = http.createServer(instrumentedHandler);
         console.log('HTTPS not configured, falling back to HTTP');
     }
 })();
@@ -3749,7 +4673,7 @@ function checkMusicHasLyrics(filePath) {
 const activeFfmpegProcesses = []; // 用于存储活跃的 ffmpeg 进程
 // 缩略图缓存目录 — 启动时 launcher 会先 `cd` 到 `src`，因此缓存目录位于项目根的 `cache`，即 __dirname 的上一级
 const CACHE_DIR = path.join(__dirname, 'cache');
-const CACHE_SUB_DIRS = ['thumbnails', 'covers', 'lyrics', 'subtitles', 'vectordata', 'videoinfo', 'musicdata', 'hls'];
+const CACHE_SUB_DIRS = ['thumbnails', 'covers', 'lyrics', 'subtitles', 'vectordata', 'videoinfo', 'musicdata', 'hls', 'cbr_segments'];
 const CACHE_FILES = ['foldercache.db'];
 const THUMBNAIL_DIR = path.join(CACHE_DIR, 'thumbnails');
 
@@ -4013,117 +4937,443 @@ function transcodeHLSSegment(videoPath, segmentIndex, outputPath, videoInfo, qua
  * @param {boolean} useRegex - 是否使用正则表达式
  * @returns {Promise<object>} 搜索结果
  */
-function performSearch(query, maxResults, matchCase, matchWholeWord, useRegex, dirs) { // 接收 dirs 参数
-    return new Promise((resolve, reject) => {
-        // 构造Python命令参数
-        const pythonPath = 'python'; // 假设系统PATH中有python命令
-        const scriptPath = path.join(__dirname, 'search.py');
+// ============================================================
+// 常驻 search.py worker
+// ============================================================
+// Everything DLL 状态与 IPC 会话在查询间保持热连接：不再为每次搜索
+// 冷启动 Python + 重新初始化 SDK。worker 崩溃时自动重启。
+const searchWorker = {
+    proc: null,
+    buffer: '',
+    pending: new Map(), // id → { resolve, reject, timer }
+    nextRequestId: 1
+};
 
-        // 构造传递给search.py的参数
-        const args = [
-            scriptPath,
-            '--query', query,
-            '--max-results', maxResults.toString()
-        ];
+function ensureSearchWorker() {
+    if (searchWorker.proc) return;
+    const proc = spawn('python', [path.join(__dirname, 'search.py'), '--serve'], {
+        cwd: __dirname,
+        env: { ...process.env, PYTHONIOENCODING: 'UTF-8' }
+    });
+    searchWorker.proc = proc;
+    searchWorker.buffer = '';
+
+    proc.stdout.on('data', (data) => {
+        searchWorker.buffer += data.toString();
+        let newlineIdx;
+        while ((newlineIdx = searchWorker.buffer.indexOf('\n')) !== -1) {
+            const line = searchWorker.buffer.slice(0, newlineIdx).trim();
+            searchWorker.buffer = searchWorker.buffer.slice(newlineIdx + 1);
+            if (!line) continue;
+            let response;
+            try {
+                response = JSON.parse(line);
+            } catch (e) {
+                console.error('[search worker] Failed to parse response:', line);
+                continue;
+            }
+            const pending = searchWorker.pending.get(response.id);
+            if (pending) {
+                clearTimeout(pending.timer);
+                searchWorker.pending.delete(response.id);
+                delete response.id; // 内部协议字段，不透传给 API 客户端
+                pending.resolve(response);
+            }
+        }
+    });
+    proc.stderr.on('data', (data) => {
+        const msg = data.toString().trim();
+        if (msg) console.error(`[search worker] ${msg}`);
+    });
+    proc.on('error', (err) => {
+        console.error('[search worker] Spawn error:', err.message);
+    });
+    proc.on('close', (code) => {
+        if (searchWorker.proc === proc) searchWorker.proc = null;
+        // worker 退出：拒绝所有挂起的查询（下次查询会重启 worker）
+        for (const [, pending] of searchWorker.pending) {
+            clearTimeout(pending.timer);
+            pending.reject(new Error(`search worker exited with code ${code}`));
+        }
+        searchWorker.pending.clear();
+    });
+}
 
-        if (matchCase) args.push('--match-case');
-        if (matchWholeWord) args.push('--match-whole-word');
-        if (useRegex) args.push('--use-regex');
+function performSearch(query, maxResults, matchCase, matchWholeWord, useRegex, dirs, paging = {}) { // 接收 dirs 参数
+    return new Promise((resolve, reject) => {
+        ensureSearchWorker();
+        if (!searchWorker.proc) {
+            reject(new Error('Failed to start search worker'));
+            return;
+        }
+        const id = searchWorker.nextRequestId++;
+        const timer = setTimeout(() => {
+            searchWorker.pending.delete(id);
+            // 查询挂死说明 worker 状态异常：杀掉让下次查询重启一个干净的
+            try { searchWorker.proc?.kill('SIGTERM'); } catch (e) { }
+            reject(new Error('search request timed out'));
+        }, 30000);
+        searchWorker.pending.set(id, { resolve, reject, timer });
 
-        // 添加目录参数
         // 如果 dirs 参数存在，则使用它，否则使用 MEDIA_DIRS
         const searchDirs = dirs ? dirs : MEDIA_DIRS.map(dir => dir.path).join(',');
-        args.push('--dirs', searchDirs);
+        const request = {
+            id,
+            query,
+            maxResults,
+            matchCase,
+            matchWholeWord,
+            useRegex,
+            dirs: searchDirs,
+            offset: paging.offset || 0,
+            sort: paging.sort || null,
+            order: paging.order || 'asc'
+        };
+        try {
+            searchWorker.proc.stdin.write(JSON.stringify(request) + '\n');
+        } catch (e) {
+            clearTimeout(timer);
+            searchWorker.pending.delete(id);
+            reject(e);
+        }
+    });
+}
 
-        // 执行Python脚本
-        const pythonProcess = spawn(pythonPath, args, {
-            cwd: __dirname,
-            stdio: ['pipe', 'pipe', 'pipe']
-        });
+// 确保缩略图目录存在
+// 确保缓存子目录存在
+CACHE_SUB_DIRS.forEach(dir => {
+    const dirPath = path.join(CACHE_DIR, dir);
+    if (!fs.existsSync(dirPath)) {
+        fs.mkdirSync(dirPath, { recursive: true });
+    }
+});
 
-        let stdoutData = '';
-        let stderrData = '';
+// ============================================================
+// 媒体库状态版本号（客户端增量同步）
+// ============================================================
+// 每个媒体根目录维护一个单调递增的变更计数器，由现有的 mtime 机制喂入：
+// /list 每次 stat 目录时观察其 mtime，变化即记一条变更。客户端把
+// 上次快照存在 IndexedDB，冷启动先渲染本地状态，再用
+// /api/library-delta?since=N 拿一条小增量决定哪些目录需要重取。
+const LIBRARY_CHANGE_LOG_LIMIT = 1000;
+// 每次进程启动的纪元戳：计数器与变更日志都在内存里，重启后从头计数。
+// 版本号以 "<纪元>-<计数>" 形式交给客户端，纪元不匹配一律全量重同步，
+// 否则停机期间的磁盘改动会被旧快照当作"无变化"。
+const LIBRARY_BOOT_EPOCH = Date.now();
+const libraryVersions = new Map(); // 媒体根目录 → { version, dirMtimes: Map, changes: [] }
+
+function libraryVersionTag(state) {
+    return `${LIBRARY_BOOT_EPOCH}-${state.version}`;
+}
 
-        pythonProcess.stdout.on('data', (data) => {
-            stdoutData += data.toString();
-        });
+function libraryStateFor(rootPath) {
+    let state = libraryVersions.get(rootPath);
+    if (!state) {
+        state = { version: 1, dirMtimes: new Map(), changes: [] };
+        libraryVersions.set(rootPath, state);
+    }
+    return state;
+}
 
-        pythonProcess.stderr.on('data', (data) => {
-            stderrData += data.toString();
-        });
+// 观察某个目录的 mtime；变化时递增版本并记录变更日志
+function observeDirectoryState(rootPath, relativeDirPath, mtimeMs) {
+    const state = libraryStateFor(rootPath);
+    const key = relativeDirPath || '/';
+    const previous = state.dirMtimes.get(key);
+    if (previous === mtimeMs) return;
+    state.dirMtimes.set(key, mtimeMs);
+    if (previous !== undefined) { // 首次观察只登记基线，不算变更
+        state.version++;
+        state.changes.push({ version: state.version, path: key });
+        if (state.changes.length > LIBRARY_CHANGE_LOG_LIMIT) state.changes.shift();
+    }
+}
 
-        pythonProcess.on('close', (code) => {
-            if (code !== 0) {
-                reject(new Error(`Python script exited with code ${code}. Stderr: ${stderrData}`));
-                return;
-            }
+// ============================================================
+// 流式目录列表
+// ============================================================
+// /list?format=ndjson&offset=&limit=&sort=name|type|size&order=asc|desc
+// 首行输出 meta（总条目数），随后每个条目一行，最后一行 done。
+// name/type 排序在 dirent 层完成，因此分页后只需 stat 当前页的文件；
+// size 排序需要全量 stat 后才能排序分页。
+const LIST_STAT_CONCURRENCY = 32;
+
+async function streamDirectoryListing(fullPath, query, req, res) {
+    const offset = Math.max(0, parseInt(query.offset || '0', 10) || 0);
+    const limit = Math.max(0, parseInt(query.limit || '0', 10) || 0); // 0 = 不限制
+    const sortKey = ['name', 'type', 'size'].includes(query.sort) ? query.sort : null;
+    const descending = query.order === 'desc';
+
+    let aborted = false;
+    req.on('close', () => { aborted = true; });
+    const writeLine = (obj) => {
+        if (!aborted && !res.writableEnded) res.write(JSON.stringify(obj) + '\n');
+    };
 
-            try {
-                // 解析Python脚本的输出
-                const results = JSON.parse(stdoutData);
-                resolve(results);
-            } catch (parseError) {
-                reject(new Error(`Failed to parse search results: ${parseError.message}. Output: ${stdoutData}`));
+    res.setHeader('Content-Type', 'application/x-ndjson');
+    res.setHeader('Cache-Control', 'no-cache');
+
+    let files;
+    try {
+        files = await fs.promises.readdir(fullPath, { withFileTypes: true });
+    } catch (e) {
+        res.statusCode = 500;
+        res.end('Internal server error');
+        return;
+    }
+
+    writeLine({ type: 'meta', total: files.length, offset, limit });
+
+    // 单个条目的 stat（与传统 /list 相同的容错语义）
+    const statEntry = (dirent) => {
+        return new Promise((resolve) => {
+            if (dirent.isDirectory()) {
+                resolve({ name: dirent.name, isDirectory: true, size: 0 });
+                return;
             }
+            fs.stat(path.join(fullPath, dirent.name), (statErr, stats) => {
+                if (statErr) {
+                    resolve({ name: dirent.name, isDirectory: false, size: 0 });
+                } else {
+                    const isDirectory = stats.isDirectory();
+                    resolve({ name: dirent.name, isDirectory, size: isDirectory ? 0 : stats.size });
+                }
+            });
         });
+    };
 
-        pythonProcess.on('error', (error) => {
-            reject(new Error(`Failed to start Python process: ${error.message}`));
+    // 有界并发地 stat 一组 dirent，每个结果就绪即回调
+    const statAll = async (dirents, onEntry) => {
+        let next = 0;
+        const workers = [];
+        const workerCount = Math.min(LIST_STAT_CONCURRENCY, dirents.length);
+        for (let w = 0; w < workerCount; w++) {
+            workers.push((async () => {
+                while (next < dirents.length && !aborted) {
+                    const entry = await statEntry(dirents[next++]);
+                    onEntry(entry);
+                }
+            })());
+        }
+        await Promise.all(workers);
+    };
+
+    const extOf = (name) => {
+        const dot = name.lastIndexOf('.');
+        return dot > 0 ? name.slice(dot + 1).toLowerCase() : '';
+    };
+
+    if (sortKey === 'size') {
+        // size 排序需要全部 stat 后才能确定顺序
+        const entries = [];
+        await statAll(files, e => entries.push(e));
+        entries.sort((a, b) => (descending ? b.size - a.size : a.size - b.size));
+        const page = limit > 0 ? entries.slice(offset, offset + limit) : entries.slice(offset);
+        for (const entry of page) writeLine(entry);
+    } else {
+        // name/type 在 dirent 层排序：分页后只 stat 当前页
+        let dirents = files;
+        if (sortKey) {
+            dirents = [...files].sort((a, b) => {
+                // 目录优先（与前端默认展示一致）
+                if (a.isDirectory() !== b.isDirectory()) return a.isDirectory() ? -1 : 1;
+                let cmp;
+                if (sortKey === 'type') {
+                    cmp = extOf(a.name).localeCompare(extOf(b.name)) || a.name.localeCompare(b.name);
+                } else {
+                    cmp = a.name.localeCompare(b.name);
+                }
+                return descending ? -cmp : cmp;
+            });
+        }
+        const page = limit > 0 ? dirents.slice(offset, offset + limit) : dirents.slice(offset);
+        await statAll(page, entry => writeLine(entry));
+    }
+
+    writeLine({ type: 'done' });
+    if (!res.writableEnded) res.end();
+}
+
+// ============================================================
+// 文件夹缩略图索引
+// ============================================================
+// /api/folder-thumbnail 过去每个请求都 readdir 一次目录来挑选代表文件
+// （封面图 > 首张图片 > 首个视频）。这里维护一个持久化的
+// 文件夹 → 代表文件 索引（cache/folder_thumb_index.json，与
+// concurrent-time-sort.py 的 cache/foldercache.db 并列），以目录 mtime
+// 失效，请求路径上只剩一次 stat；后台定期刷新失效条目。
+const FOLDER_THUMB_INDEX_PATH = path.join(CACHE_DIR, 'folder_thumb_index.json');
+const FOLDER_THUMB_REFRESH_INTERVAL_MS = (config.folder_thumb_refresh_interval_seconds || 600) * 1000;
+const folderThumbIndex = new Map(); // 文件夹绝对路径 → { type, file, mtimeMs, checkedAt }
+let folderThumbIndexSaveTimer = null;
+
+const FOLDER_COVER_NAMES = ['cover', 'folder', 'front', 'back'];
+const FOLDER_IMAGE_EXTENSIONS = ['.jpg', '.jpeg', '.png', '.gif', '.bmp', '.webp'];
+const FOLDER_VIDEO_EXTENSIONS = [
+    // 现代网络格式 (多数浏览器原生支持)
+    '.mp4', '.webm', '.ogv',
+    // Apple 格式
+    '.mov', '.m4v',
+    // 常见封装格式 (浏览器支持度不一，通常需要插件或转码)
+    '.avi', '.mkv', '.flv', '.f4v', '.wmv', '.asf',
+    // 高清/光盘/流格式
+    '.ts', '.mts', '.m2ts', '.vob', '.m2p',
+    // 移动端/老旧格式
+    '.3gp', '.3g2', '.rmvb', '.rm', '.mpg', '.mpeg', '.m1v', '.m4p',
+    // 专业级
+    '.mxf', '.dv'
+];
+
+// 启动时加载持久化索引
+try {
+    const saved = JSON.parse(fs.readFileSync(FOLDER_THUMB_INDEX_PATH, 'utf-8'));
+    for (const [key, entry] of Object.entries(saved)) {
+        folderThumbIndex.set(key, entry);
+    }
+    console.log(`[folder-thumb index] Loaded ${folderThumbIndex.size} entries`);
+} catch (e) {
+    // 索引不存在或损坏：从空索引开始，按需重建
+}
+
+function scheduleFolderThumbIndexSave() {
+    if (folderThumbIndexSaveTimer) return;
+    folderThumbIndexSaveTimer = setTimeout(() => {
+        folderThumbIndexSaveTimer = null;
+        const obj = Object.fromEntries(folderThumbIndex);
+        fs.writeFile(FOLDER_THUMB_INDEX_PATH, JSON.stringify(obj), (err) => {
+            if (err) console.error('[folder-thumb index] Save failed:', err.message);
         });
-    });
+    }, 5000);
 }
 
-// 确保缩略图目录存在
-// 确保缓存子目录存在
-CACHE_SUB_DIRS.forEach(dir => {
-    const dirPath = path.join(CACHE_DIR, dir);
-    if (!fs.existsSync(dirPath)) {
-        fs.mkdirSync(dirPath, { recursive: true });
+/**
+ * 扫描一个文件夹，挑选代表文件（封面图 > 首张图片 > 首个视频）
+ * @returns {Promise<{type: 'image'|'video'|'none', file: string|null}>}
+ */
+async function findFolderRepresentative(fullPath) {
+    const files = await fs.promises.readdir(fullPath);
+
+    // 1. 查找专辑封面
+    for (const name of FOLDER_COVER_NAMES) {
+        for (const ext of FOLDER_IMAGE_EXTENSIONS) {
+            const coverFile = name + ext;
+            const match = files.find(f => f.toLowerCase() === coverFile);
+            if (match) {
+                return { type: 'image', file: match };
+            }
+        }
     }
-});
+
+    // 2. 查找图片（优先于视频）
+    const firstImage = files.find(f => FOLDER_IMAGE_EXTENSIONS.includes(path.extname(f).toLowerCase()));
+    if (firstImage) {
+        return { type: 'image', file: firstImage };
+    }
+
+    // 3. 查找视频（由 /thumbnail 生成缩略图）
+    const firstVideo = files.find(f => FOLDER_VIDEO_EXTENSIONS.includes(path.extname(f).toLowerCase()));
+    if (firstVideo) {
+        return { type: 'video', file: firstVideo };
+    }
+
+    return { type: 'none', file: null };
+}
+
+/**
+ * 后台刷新：重新校验索引条目，失效的重扫，消失的目录移除。
+ * 逐个顺序处理，避免刷新风暴挤占前台 I/O。
+ */
+async function refreshFolderThumbIndex() {
+    let changed = false;
+    for (const [folderPath, entry] of folderThumbIndex) {
+        try {
+            const stats = await fs.promises.stat(folderPath);
+            if (stats.mtimeMs !== entry.mtimeMs) {
+                const rep = await findFolderRepresentative(folderPath);
+                folderThumbIndex.set(folderPath, { type: rep.type, file: rep.file, mtimeMs: stats.mtimeMs, checkedAt: Date.now() });
+                changed = true;
+            }
+        } catch (e) {
+            // 目录已消失
+            folderThumbIndex.delete(folderPath);
+            changed = true;
+        }
+    }
+    if (changed) scheduleFolderThumbIndexSave();
+}
+
+setInterval(refreshFolderThumbIndex, FOLDER_THUMB_REFRESH_INTERVAL_MS).unref();
 
 // 缩略图生成队列和并发控制
-const thumbnailQueue = []; // 待处理的缩略图任务队列
+// 栈式优先级：最新请求的磁贴（即用户当前可见的）优先出队，
+// 滚动过去的磁贴沉底，客户端断开后直接丢弃而不是继续生成。
+const thumbnailQueue = []; // 待处理的缩略图任务栈（末尾为最新请求）
+const queuedThumbnailTasks = new Map(); // key（缩略图路径）→ task，用于去重与重排
 let activeGenerations = 0; // 当前正在进行的缩略图生成任务数
-const MAX_CONCURRENT_GENERATIONS = 4; // 最大并发生成任务数
+const MAX_CONCURRENT_GENERATIONS = config.thumbnail_max_concurrency || Math.max(2, os.cpus().length * 2); // 最大并发生成任务数
 
 /**
  * 缩略图任务队列处理器
  */
 function processThumbnailQueue() {
-    // 如果达到最大并发数或队列为空，则不处理
-    if (activeGenerations >= MAX_CONCURRENT_GENERATIONS || thumbnailQueue.length === 0) {
-        return;
+    while (activeGenerations < MAX_CONCURRENT_GENERATIONS && thumbnailQueue.length > 0) {
+        // 从栈顶取出最新请求的任务
+        const task = thumbnailQueue.pop();
+        queuedThumbnailTasks.delete(task.key);
+
+        // 所有请求方都已断开（滚动过去的磁贴）：丢弃任务
+        if (isThumbnailTaskCancelled(task)) {
+            task.waiters.forEach(w => w.reject(new Error('Thumbnail generation cancelled')));
+            continue;
+        }
+
+        activeGenerations++;
+        // 执行缩略图生成
+        task.generate()
+            .then((value) => task.waiters.forEach(w => w.resolve(value)))
+            .catch((err) => task.waiters.forEach(w => w.reject(err)))
+            .finally(() => {
+                activeGenerations--;
+                // 继续处理队列中的下一个任务
+                processThumbnailQueue();
+            });
     }
+}
 
-    // 从队列中取出一个任务
-    const task = thumbnailQueue.shift();
-    activeGenerations++;
-
-    // 执行缩略图生成
-    task.generate()
-        .then(task.resolve)
-        .catch(task.reject)
-        .finally(() => {
-            activeGenerations--;
-            // 继续处理队列中的下一个任务
-            processThumbnailQueue();
-        });
+function isThumbnailTaskCancelled(task) {
+    return task.waiters.every(w => w.cancelToken && w.cancelToken.cancelled);
 }
 
 /**
  * 将缩略图生成任务加入队列
  * @param {Function} generateFn - 生成缩略图的函数
+ * @param {string} [key] - 任务去重键（通常为缩略图输出路径）
+ * @param {{cancelled: boolean}} [cancelToken] - 请求方断开时置位，任务出队时跳过
  * @returns {Promise<void>}
  */
-function queueThumbnailGeneration(generateFn) {
+function queueThumbnailGeneration(generateFn, key, cancelToken) {
     return new Promise((resolve, reject) => {
-        // 将任务添加到队列
-        thumbnailQueue.push({
+        const waiter = { resolve, reject, cancelToken };
+
+        // 同一缩略图已在排队：附加等待者并提升到栈顶（该磁贴刚刚又被请求，说明可见）
+        if (key && queuedThumbnailTasks.has(key)) {
+            const task = queuedThumbnailTasks.get(key);
+            task.waiters.push(waiter);
+            const idx = thumbnailQueue.indexOf(task);
+            if (idx !== -1 && idx !== thumbnailQueue.length - 1) {
+                thumbnailQueue.splice(idx, 1);
+                thumbnailQueue.push(task);
+            }
+            return;
+        }
+
+        const task = {
+            key,
             generate: generateFn,
-            resolve,
-            reject
-        });
+            waiters: [waiter]
+        };
+        thumbnailQueue.push(task);
+        if (key) queuedThumbnailTasks.set(key, task);
 
         // 尝试处理队列
         processThumbnailQueue();
@@ -4136,7 +5386,7 @@ function queueThumbnailGeneration(generateFn) {
  * @param {string} thumbnailPath - 缩略图保存路径
  * @returns {Promise<void>}
  */
-function generateVideoThumbnail(videoPath, thumbnailPath) {
+function generateVideoThumbnail(videoPath, thumbnailPath, cancelToken) {
     return queueThumbnailGeneration(() => {
         return new Promise((resolve, reject) => {
             // 使用 ffmpeg 生成视频缩略图
@@ -4181,7 +5431,7 @@ function generateVideoThumbnail(videoPath, thumbnailPath) {
                 reject(error);
             });
         });
-    });
+    }, thumbnailPath, cancelToken);
 }
 
 /**
@@ -4190,7 +5440,7 @@ function generateVideoThumbnail(videoPath, thumbnailPath) {
  * @param {string} thumbnailPath - 缩略图保存路径
  * @returns {Promise<void>}
  */
-function generateImageThumbnail(imagePath, thumbnailPath) {
+function generateImageThumbnail(imagePath, thumbnailPath, cancelToken) {
     return queueThumbnailGeneration(() => {
         return new Promise((resolve, reject) => {
             // 使用 ffmpeg 生成图片缩略图
@@ -4223,7 +5473,80 @@ function generateImageThumbnail(imagePath, thumbnailPath) {
                 reject(error);
             });
         });
+    }, thumbnailPath, cancelToken);
+}
+
+/**
+ * 秒数 → WebVTT 时间戳 (HH:MM:SS.mmm)
+ */
+function formatVttTime(seconds) {
+    const h = Math.floor(seconds / 3600);
+    const m = Math.floor((seconds % 3600) / 60);
+    const s = (seconds % 60).toFixed(3);
+    return `${String(h).padStart(2, '0')}:${String(m).padStart(2, '0')}:${String(s).padStart(6, '0')}`;
+}
+
+/**
+ * 生成进度条雪碧图：一次 ffmpeg 解码同时产出
+ * 10x10 网格（配 WebVTT storyboard）与 100x1 横条（DPlayer thumbnails 格式）。
+ * @param {string} videoPath - 视频文件路径
+ * @param {string} spritePath - 10x10 网格输出路径
+ * @param {string} stripPath - 100x1 横条输出路径
+ * @param {string} vttPath - WebVTT storyboard 输出路径
+ * @returns {Promise<void>}
+ */
+async function generateStoryboard(videoPath, spritePath, stripPath, vttPath) {
+    const STORYBOARD_FRAMES = 100;
+    const TILE_W = 160;
+    const TILE_H = 90;
+
+    // 采样间隔铺满全片：100 帧覆盖完整时长
+    const duration = await getAudioDurationSec(videoPath);
+    const interval = Math.max(1, duration / STORYBOARD_FRAMES);
+    const scalePad = `fps=1/${interval},scale=${TILE_W}:${TILE_H}:force_original_aspect_ratio=decrease,pad=${TILE_W}:${TILE_H}:(ow-iw)/2:(oh-ih)/2`;
+
+    await new Promise((resolve, reject) => {
+        const ffmpeg = spawn('ffmpeg', [
+            '-hide_banner', '-loglevel', 'error', '-y',
+            '-i', videoPath,
+            '-filter_complex', `[0:v]${scalePad},split=2[grid][strip];[grid]tile=10x10[g];[strip]tile=100x1[s]`,
+            '-map', '[g]', '-frames:v', '1', '-q:v', '5', spritePath,
+            '-map', '[s]', '-frames:v', '1', '-q:v', '5', stripPath
+        ]);
+        activeFfmpegProcesses.push(ffmpeg);
+
+        let stderrOutput = '';
+        ffmpeg.stderr.on('data', d => { stderrOutput += d.toString(); });
+        ffmpeg.on('error', (err) => {
+            const idx = activeFfmpegProcesses.indexOf(ffmpeg);
+            if (idx > -1) activeFfmpegProcesses.splice(idx, 1);
+            reject(err);
+        });
+        ffmpeg.on('close', (code) => {
+            const idx = activeFfmpegProcesses.indexOf(ffmpeg);
+            if (idx > -1) activeFfmpegProcesses.splice(idx, 1);
+            if (code === 0) {
+                resolve();
+            } else {
+                console.error('[storyboard] ffmpeg stderr:', stderrOutput);
+                reject(new Error(`ffmpeg exited with code ${code}`));
+            }
+        });
     });
+
+    // 写 WebVTT storyboard（每个 cue 引用网格图中的一块）
+    const spriteName = path.basename(spritePath);
+    const cueCount = Math.min(STORYBOARD_FRAMES, Math.max(1, Math.ceil(duration / interval)));
+    let vtt = 'WEBVTT\n\n';
+    for (let i = 0; i < cueCount; i++) {
+        const start = i * interval;
+        const end = Math.min(duration, (i + 1) * interval);
+        const x = (i % 10) * TILE_W;
+        const y = Math.floor(i / 10) * TILE_H;
+        vtt += `${formatVttTime(start)} --> ${formatVttTime(end)}\n/cache/thumbnails/${spriteName}#xywh=${x},${y},${TILE_W},${TILE_H}\n\n`;
+    }
+    await fs.promises.writeFile(vttPath, vtt);
+    console.log(`[storyboard] Generated: ${spriteName} (${cueCount} cues, interval ${interval.toFixed(1)}s)`);
 }
 
 /**
@@ -4242,8 +5565,12 @@ function stopAllThumbnailGenerations() {
     });
     activeFfmpegProcesses.length = 0; // 清空活跃进程列表
 
-    // 清空缩略图生成队列
+    // 清空缩略图生成队列，并让所有等待中的请求立即收到取消错误（而不是永远挂起）
+    thumbnailQueue.forEach(task => {
+        task.waiters.forEach(w => w.reject(new Error('Thumbnail generation cancelled')));
+    });
     thumbnailQueue.length = 0;
+    queuedThumbnailTasks.clear();
     //console.log('Thumbnail queue cleared.');
 }
 
@@ -4621,9 +5948,38 @@ function getLastSubtitleTimestamp(vttPath) {
     }
 }
 
+// 请求后端预处理音频（流水线转录：与当前文件的 GPU 推理并行执行）。
+// 后端不可用或失败时返回 null，转录时退回自行预处理。
+function requestAudioPreprocess(filePath) {
+    return new Promise((resolve) => {
+        const body = JSON.stringify({ videoPath: filePath });
+        const proxyReq = http.request({
+            hostname: '127.0.0.1',
+            port: 5000,
+            path: '/api/preprocess_audio',
+            method: 'POST',
+            headers: { 'Content-Type': 'application/json', 'Content-Length': Buffer.byteLength(body) }
+        }, proxyRes => {
+            let responseBody = '';
+            proxyRes.on('data', d => { responseBody += d.toString(); });
+            proxyRes.on('end', () => {
+                try {
+                    const result = JSON.parse(responseBody);
+                    resolve(result.success ? result.processed_audio_path : null);
+                } catch (e) {
+                    resolve(null);
+                }
+            });
+        });
+        proxyReq.on('error', () => resolve(null));
+        proxyReq.write(body);
+        proxyReq.end();
+    });
+}
+
 function transcribeFileWithFallback(filePath, options) {
     return new Promise((resolve) => {
-        const { model, modelSource, language, task, vadFilter, denseSubtitles, maxCharsPerLine } = options;
+        const { model, modelSource, language, task, vadFilter, denseSubtitles, maxCharsPerLine, preprocessedAudioPath } = options;
 
         const flaskData = {
             videoPath: filePath,
@@ -4635,6 +5991,9 @@ function transcribeFileWithFallback(filePath, options) {
             denseSubtitles: !!denseSubtitles,
             maxCharsPerLine: maxCharsPerLine || 30
         };
+        if (preprocessedAudioPath) {
+            flaskData.preprocessedAudioPath = preprocessedAudioPath;
+        }
 
         const flaskBody = JSON.stringify(flaskData);
 
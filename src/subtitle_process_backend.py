@@ -3,8 +3,11 @@ from flask_cors import CORS
 from urllib.parse import unquote
 from sentence_transformers import SentenceTransformer
 import faiss
+import numpy as np
 import os
 import sys
+import time
+import threading
 import pickle
 import hashlib
 import torch
@@ -42,16 +45,25 @@ CURRENT_WHISPER_MODEL_CONFIG = None
 TRANSCRIBER_CONFIGS = []
 
 def load_transcriber_configs():
-    global TRANSCRIBER_CONFIGS
+    global TRANSCRIBER_CONFIGS, WHISPER_IDLE_UNLOAD_SECONDS
     config_path = os.path.join(os.path.dirname(__file__), 'config.json')
     try:
         with open(config_path, 'r', encoding='utf-8') as f:
             config = json.load(f)
             TRANSCRIBER_CONFIGS = config.get('transcriber_models', [])
+            WHISPER_IDLE_UNLOAD_SECONDS = config.get('whisper_idle_unload_seconds', 600)
     except Exception as e:
         print(f"加载配置文件失败: {e}")
         TRANSCRIBER_CONFIGS = []
 
+# Whisper 空闲卸载：模型常驻进程（单文件任务秒级开始转录），
+# 但长时间无转录请求时自动卸载以释放显存；下个请求到达时透明重载。
+# 设为 0 可禁用空闲卸载。
+WHISPER_IDLE_UNLOAD_SECONDS = 600
+WHISPER_LAST_USED = 0.0
+WHISPER_ACTIVE_JOBS = 0
+whisper_state_lock = threading.Lock()
+
 load_transcriber_configs()
 
 # 运行中的任务管理（存储正在处理的任务，用于取消）
@@ -59,25 +71,238 @@ import threading
 running_tasks = {}  # key: task_id, value: {'thread': thread_obj, 'cancel_flag': threading.Event()}
 running_tasks_lock = threading.Lock()
 
-# --- 服务启动时加载模型 ---
+# --- 跨任务共享的推理调度器 ---
+class InferenceScheduler:
+    """把所有活动字幕任务的本地模型调用汇入同一个队列。
+
+    - 公平性：按任务（提交线程）轮转出队，五集排队翻译时不再是
+      一集独占模型、四集干等。
+    - 合批：Transformers 路径把同一模型、同一任务类型的多条提示
+      合成一个 batch 喂给 model.generate；GGUF (llama.cpp) 是单流
+      推理，调度器按轮转逐条执行（同时保证了线程安全——此前多个
+      请求线程直接并发调用模型）。
+    - 进度：各任务的 _report_progress 回调在各自线程中照常发出。
+    """
+
+    def __init__(self, max_batch_size=4):
+        self.max_batch_size = max_batch_size
+        self._cv = threading.Condition()
+        self._queues = {}      # job_id（提交线程 id）→ [request, ...]
+        self._job_order = []   # 轮转顺序
+        self._rr_index = 0
+        self._worker = None
+
+    def generate(self, corrector, prompt, is_translation):
+        """排队执行一次纠错/翻译推理，阻塞直到结果可用。"""
+        return self._enqueue(corrector, {
+            'mode': 'chat',
+            'prompt': prompt,
+            'is_translation': is_translation
+        })
+
+    def generate_raw(self, corrector, prompt, system_prompt=None):
+        """排队执行一次原始提示推理（术语表等）；与纠错/翻译共用同一条队列，
+        保证本地模型永远只被调度器线程串行/合批地调用。"""
+        return self._enqueue(corrector, {
+            'mode': 'raw',
+            'prompt': prompt,
+            'system_prompt': system_prompt
+        })
+
+    def _enqueue(self, corrector, fields):
+        job_id = threading.get_ident()
+        request = {
+            'corrector': corrector,
+            'event': threading.Event(),
+            'result': None,
+            'error': None,
+            **fields
+        }
+        with self._cv:
+            if job_id not in self._queues:
+                self._queues[job_id] = []
+                self._job_order.append(job_id)
+            self._queues[job_id].append(request)
+            if self._worker is None or not self._worker.is_alive():
+                self._worker = threading.Thread(target=self._run, daemon=True)
+                self._worker.start()
+            self._cv.notify_all()
+
+        request['event'].wait()
+        if request['error'] is not None:
+            raise request['error']
+        return request['result']
+
+    @staticmethod
+    def _can_cobatch(first, candidate):
+        """两条请求能否进同一个 Transformers batch（生成参数必须一致）。"""
+        if candidate['corrector'] is not first['corrector']:
+            return False
+        if candidate['mode'] != first['mode']:
+            return False
+        if first['mode'] == 'chat':
+            return candidate['is_translation'] == first['is_translation']
+        return candidate.get('system_prompt') == first.get('system_prompt')
+
+    def _collect_batch(self):
+        """按任务轮转收集下一批请求（调用时必须持有 self._cv）。
+
+        批内约束：同一 corrector、同一模式（chat 同任务类型 / raw 同
+        system_prompt）、Transformers 格式才能合批；GGUF 每批只取一条。
+        """
+        # 清理空队列
+        for job_id in list(self._job_order):
+            if not self._queues.get(job_id):
+                self._queues.pop(job_id, None)
+                self._job_order.remove(job_id)
+        if not self._job_order:
+            return []
+
+        if self._rr_index >= len(self._job_order):
+            self._rr_index = 0
+
+        # 第一条请求决定本批的 corrector 与任务类型
+        first_job = self._job_order[self._rr_index]
+        first = self._queues[first_job].pop(0)
+        batch = [first]
+        self._rr_index = (self._rr_index + 1) % max(len(self._job_order), 1)
+
+        corrector = first['corrector']
+        if corrector.model_format != 'transformers':
+            return batch
+
+        # 轮转着从其他任务补齐本批
+        scanned = 0
+        while len(batch) < self.max_batch_size and scanned < len(self._job_order):
+            job_id = self._job_order[self._rr_index % len(self._job_order)]
+            queue_for_job = self._queues.get(job_id)
+            if queue_for_job:
+                candidate = queue_for_job[0]
+                if self._can_cobatch(first, candidate):
+                    batch.append(queue_for_job.pop(0))
+            self._rr_index = (self._rr_index + 1) % len(self._job_order)
+            scanned += 1
+        return batch
+
+    def _run(self):
+        while True:
+            with self._cv:
+                batch = self._collect_batch()
+                while not batch:
+                    # 空闲 30 秒后退出，有新请求时再拉起
+                    if not self._cv.wait(timeout=30):
+                        self._worker = None
+                        return
+                    batch = self._collect_batch()
+
+            corrector = batch[0]['corrector']
+
+            def run_single(request):
+                if request['mode'] == 'raw':
+                    return corrector._generate_local_raw(request['prompt'], request.get('system_prompt'))
+                return corrector._generate_local(request['prompt'], request['is_translation'])
+
+            try:
+                if corrector.model_format == 'transformers' and len(batch) > 1:
+                    try:
+                        if batch[0]['mode'] == 'raw':
+                            results = corrector._generate_local_raw_transformers_batch(
+                                [r['prompt'] for r in batch],
+                                batch[0].get('system_prompt')
+                            )
+                        else:
+                            results = corrector._generate_local_transformers_batch(
+                                [r['prompt'] for r in batch],
+                                batch[0]['is_translation']
+                            )
+                        for request, result in zip(batch, results):
+                            request['result'] = result
+                    except Exception as e:
+                        print(f"合批推理失败，回退到逐条执行: {e}")
+                        for request in batch:
+                            try:
+                                request['result'] = run_single(request)
+                            except Exception as single_error:
+                                request['error'] = single_error
+                else:
+                    for request in batch:
+                        try:
+                            request['result'] = run_single(request)
+                        except Exception as single_error:
+                            request['error'] = single_error
+            finally:
+                for request in batch:
+                    request['event'].set()
+
+
+INFERENCE_SCHEDULER = InferenceScheduler()
+
+
+# --- 组件就绪状态（/api/readiness 汇报；UI 无需等模型加载完） ---
+COMPONENT_STATUS = {
+    'semantic': 'not_loaded',      # not_loaded | loading | ready | error
+    'corrector': 'not_loaded',
+    'transcription': 'not_loaded'
+}
+_component_locks = {name: threading.Lock() for name in COMPONENT_STATUS}
+
+
+def ensure_semantic_model():
+    """按需加载语义搜索模型（首次使用时才加载，双检锁防止并发重复加载）。"""
+    if MODEL is None:
+        with _component_locks['semantic']:
+            if MODEL is None:
+                load_global_model()
+    return MODEL is not None
+
+
+def ensure_corrector_model():
+    """按需加载纠错/翻译模型。"""
+    if CORRECTOR is None:
+        with _component_locks['corrector']:
+            if CORRECTOR is None:
+                load_corrector_model()
+    return CORRECTOR is not None and (CORRECTOR.model or CORRECTOR.online_mode)
+
+
+def ensure_transcription_model():
+    """按需加载 Whisper 转录模型。"""
+    if WHISPER_MODEL is None:
+        with _component_locks['transcription']:
+            if WHISPER_MODEL is None:
+                load_transcription_model()
+    return WHISPER_MODEL is not None
+
+
+# --- 模型加载（惰性：启动时不再阻塞，首个请求或后台预热线程触发） ---
 def load_global_model():
-    """在服务启动时加载一次 Sentence Transformer 模型。"""
+    """加载 Sentence Transformer 模型（含就绪状态汇报）。"""
     global MODEL
     if MODEL is None:
-        print(f"正在加载全局模型: {MODEL_NAME}...")
-        MODEL = SentenceTransformer(MODEL_NAME)
-        print("全局模型加载完毕。")
+        COMPONENT_STATUS['semantic'] = 'loading'
+        try:
+            print(f"正在加载全局模型: {MODEL_NAME}...")
+            MODEL = SentenceTransformer(MODEL_NAME)
+            COMPONENT_STATUS['semantic'] = 'ready'
+            print("全局模型加载完毕。")
+        except Exception as e:
+            COMPONENT_STATUS['semantic'] = 'error'
+            print(f"加载语义搜索模型失败: {e}")
 
 def load_corrector_model():
-    """在服务启动时加载 VTT 纠错模型。"""
+    """加载 VTT 纠错模型（含就绪状态汇报）。"""
     global CORRECTOR
     if CORRECTOR is None:
+        COMPONENT_STATUS['corrector'] = 'loading'
         print("正在初始化字幕纠错/翻译模块...")
         # 确保模型目录和默认配置存在
         setup_model_directory()
         try:
             # auto_load_model_index=0 表示自动加载配置文件中的第一个模型
             CORRECTOR = VTTCorrector(auto_load_model_index=0)
+            # 本地模型推理经由跨任务共享的调度器（排队/合批/公平轮转）
+            CORRECTOR.inference_scheduler = INFERENCE_SCHEDULER
+            COMPONENT_STATUS['corrector'] = 'ready' if (CORRECTOR.model or CORRECTOR.online_mode) else 'error'
             if CORRECTOR.model:
                 if CORRECTOR.online_mode:
                     print(f"在线聊天模型已激活: {CORRECTOR.online_model_name}")
@@ -86,9 +311,45 @@ def load_corrector_model():
             else:
                 print("警告: 字幕纠错/翻译模型未能加载。请检查 'models/model_config.json' 配置。")
         except Exception as e:
+            COMPONENT_STATUS['corrector'] = 'error'
             print(f"错误: 初始化字幕纠错/翻译模块失败: {e}")
             print("  - 请确保 'models' 目录下有正确的模型文件和 'model_config.json' 配置文件。")
 
+def _touch_whisper():
+    """记录 Whisper 模型的最近使用时间（空闲卸载计时基准）。"""
+    global WHISPER_LAST_USED
+    WHISPER_LAST_USED = time.time()
+
+
+def _whisper_idle_watchdog():
+    """后台线程：模型空闲超过 WHISPER_IDLE_UNLOAD_SECONDS 后卸载释放显存。
+
+    复用 /api/unload_models 的卸载方式；正在转录时（WHISPER_ACTIVE_JOBS > 0）
+    不会卸载。下个转录请求到达时由 load_transcription_model 透明重载。
+    """
+    global WHISPER_MODEL, CURRENT_WHISPER_MODEL_CONFIG
+    while True:
+        time.sleep(60)
+        if WHISPER_IDLE_UNLOAD_SECONDS <= 0:
+            continue
+        with whisper_state_lock:
+            if (WHISPER_MODEL is not None
+                    and WHISPER_ACTIVE_JOBS == 0
+                    and time.time() - WHISPER_LAST_USED > WHISPER_IDLE_UNLOAD_SECONDS):
+                print(f"Whisper 模型空闲超过 {WHISPER_IDLE_UNLOAD_SECONDS} 秒，卸载以释放显存。")
+                del WHISPER_MODEL
+                WHISPER_MODEL = None
+                CURRENT_WHISPER_MODEL_CONFIG = None
+                import gc as _gc
+                _gc.collect()
+                if torch.cuda.is_available():
+                    torch.cuda.empty_cache()
+                print("Whisper 转录模型已卸载（空闲超时）。")
+
+
+threading.Thread(target=_whisper_idle_watchdog, daemon=True).start()
+
+
 def load_transcription_model(model_index=0):
     """在服务启动时加载 Whisper 转录模型。"""
     global WHISPER_MODEL, CURRENT_WHISPER_MODEL_CONFIG
@@ -111,6 +372,7 @@ def load_transcription_model(model_index=0):
         return
 
     print(f"正在加载 Whisper 转录模型 ({model_identifier})...")
+    COMPONENT_STATUS['transcription'] = 'loading'
     try:
         # 卸载旧模型（如果有）
         if WHISPER_MODEL is not None:
@@ -120,8 +382,11 @@ def load_transcription_model(model_index=0):
         
         WHISPER_MODEL = generate_subtitle.load_model(model_source, model_identifier)
         CURRENT_WHISPER_MODEL_CONFIG = config
+        _touch_whisper()
+        COMPONENT_STATUS['transcription'] = 'ready'
         print(f"Whisper 转录模型 ({model_identifier}) 加载完毕。")
     except Exception as e:
+        COMPONENT_STATUS['transcription'] = 'error'
         print(f"加载 Whisper 模型失败: {e}")
         WHISPER_MODEL = None
         CURRENT_WHISPER_MODEL_CONFIG = None
@@ -134,9 +399,19 @@ def get_or_build_index(vtt_file, chunk_params, force_rebuild=False):
     新增 force_rebuild 参数用于强制重建索引。
     """
     # --- 磁盘缓存路径 ---
-    # 将分块参数加入哈希计算，确保缓存的唯一性
+    # 将分块参数与文件内容哈希一并加入计算：不同的分块策略使用不同的缓存，
+    # 且 VTT 内容变化后旧索引自动失效（变化的块由 build_index 增量编码）
     params_str = f"-{chunk_params['max_gap_seconds']}-{chunk_params['max_chunk_length']}"
-    hash_input = vtt_file + params_str
+    content_hash = ''
+    try:
+        h = hashlib.md5()
+        with open(vtt_file, 'rb') as fh:
+            for chunk in iter(lambda: fh.read(8192), b''):
+                h.update(chunk)
+        content_hash = h.hexdigest()[:8]
+    except Exception:
+        pass  # 文件不存在时由下方的 FileNotFoundError 处理
+    hash_input = vtt_file + params_str + '-' + content_hash
     file_hash = hashlib.md5(hash_input.encode('utf-8')).hexdigest()
     
     index_file_path = os.path.join(CACHE_DIR, file_hash + ".faiss_index")
@@ -169,7 +444,8 @@ def get_or_build_index(vtt_file, chunk_params, force_rebuild=False):
         max_gap_seconds=chunk_params['max_gap_seconds'],
         max_chunk_length=chunk_params['max_chunk_length']
     )
-    index, entries = logic.build_index(entries, MODEL)
+    # 传入 vtt_file/模型名以启用持久化向量缓存：只有文本变化的块才会重新编码
+    index, entries = logic.build_index(entries, MODEL, vtt_file=vtt_file, model_name=MODEL_NAME)
 
     # 保存到磁盘缓存
     if not os.path.exists(CACHE_DIR):
@@ -182,6 +458,201 @@ def get_or_build_index(vtt_file, chunk_params, force_rebuild=False):
     return index, entries
 
 
+# --- 库级语义索引（跨文件 ANN 搜索）---
+# 对 cache/subtitles 下的全部 VTT 构建一个 HNSW 索引，支持跨整个媒体库
+# 搜索对白；数十万块规模下查询延迟仍在亚 100ms 量级。
+# 向量复用 semantic_search_logic.encode_entries 的持久化缓存，
+# 因此增量刷新只需为新增/变化的文件编码。
+SUBTITLE_LIBRARY_DIR = os.path.join(os.path.dirname(__file__), "cache", "subtitles")
+LIBRARY_INDEX_PATH = os.path.join(CACHE_DIR, "library.faiss_index")
+LIBRARY_META_PATH = os.path.join(CACHE_DIR, "library_meta.pickle")
+LIBRARY_CHUNK_PARAMS = {"max_gap_seconds": 5.0, "max_chunk_length": 300}
+
+LIBRARY_INDEX = None      # faiss.IndexHNSWFlat（内积度量）
+LIBRARY_ENTRIES = []      # 与索引行对齐: {vtt_file, start, end, text, valid}
+LIBRARY_MANIFEST = {}     # vtt_file -> {"content_hash": str, "entry_ids": [int]}
+library_index_lock = threading.Lock()
+
+
+def _vtt_content_hash(path):
+    """计算 VTT 文件内容哈希（与 generate_subtitle.compute_file_hash 相同的模式）。"""
+    h = hashlib.md5()
+    with open(path, 'rb') as fh:
+        for chunk in iter(lambda: fh.read(8192), b''):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def _load_library_index():
+    """从磁盘加载库级索引（存在时）。只在首次使用时调用。"""
+    global LIBRARY_INDEX, LIBRARY_ENTRIES, LIBRARY_MANIFEST
+    if LIBRARY_INDEX is not None:
+        return
+    if os.path.exists(LIBRARY_INDEX_PATH) and os.path.exists(LIBRARY_META_PATH):
+        try:
+            with open(LIBRARY_META_PATH, 'rb') as f:
+                meta = pickle.load(f)
+            # 换过语义模型后旧向量不可比，丢弃索引从头重建
+            if meta.get('model_name') != MODEL_NAME:
+                print(f"库级索引由模型 {meta.get('model_name')} 构建，当前为 {MODEL_NAME}，将重建。")
+                return
+            LIBRARY_INDEX = faiss.read_index(LIBRARY_INDEX_PATH)
+            LIBRARY_ENTRIES = meta['entries']
+            LIBRARY_MANIFEST = meta['manifest']
+            print(f"库级语义索引已加载: {LIBRARY_INDEX.ntotal} 块 / {len(LIBRARY_MANIFEST)} 个文件")
+        except Exception as e:
+            print(f"加载库级索引失败，将重建: {e}")
+            LIBRARY_INDEX = None
+            LIBRARY_ENTRIES = []
+            LIBRARY_MANIFEST = {}
+
+
+def _save_library_index():
+    if LIBRARY_INDEX is None:
+        return
+    if not os.path.exists(CACHE_DIR):
+        os.makedirs(CACHE_DIR)
+    faiss.write_index(LIBRARY_INDEX, LIBRARY_INDEX_PATH)
+    with open(LIBRARY_META_PATH, 'wb') as f:
+        pickle.dump({'entries': LIBRARY_ENTRIES, 'manifest': LIBRARY_MANIFEST, 'model_name': MODEL_NAME}, f)
+
+
+def add_file_to_library_index(vtt_file, save=True):
+    """把单个 VTT 增量加入库级索引（文件未变化时为空操作）。
+
+    HNSW 不支持删除：文件内容变化时旧块标记为 invalid（查询时过滤），
+    新块追加到索引末尾。
+    """
+    global LIBRARY_INDEX
+    if not ensure_semantic_model():
+        print("库级索引: 语义模型加载失败，跳过增量更新。")
+        return False
+    vtt_file = os.path.abspath(vtt_file)
+    with library_index_lock:
+        _load_library_index()
+        try:
+            content_hash = _vtt_content_hash(vtt_file)
+        except OSError as e:
+            print(f"库级索引: 无法读取 {vtt_file}: {e}")
+            return False
+
+        known = LIBRARY_MANIFEST.get(vtt_file)
+        if known and known['content_hash'] == content_hash:
+            return False  # 未变化
+
+        entries = logic.load_vtt(vtt_file, **LIBRARY_CHUNK_PARAMS)
+        if not entries:
+            return False
+        embeddings = logic.encode_entries(entries, MODEL, vtt_file=vtt_file, model_name=MODEL_NAME)
+
+        # 维度不匹配说明索引由其他模型构建（进程内切换过模型）：重建
+        if LIBRARY_INDEX is not None and LIBRARY_INDEX.d != embeddings.shape[1]:
+            print("库级索引: 向量维度与当前模型不符，重建索引。")
+            LIBRARY_INDEX = None
+            LIBRARY_ENTRIES.clear()
+            LIBRARY_MANIFEST.clear()
+            known = None
+
+        if LIBRARY_INDEX is None:
+            dim = embeddings.shape[1]
+            LIBRARY_INDEX = faiss.IndexHNSWFlat(dim, 32, faiss.METRIC_INNER_PRODUCT)
+            LIBRARY_INDEX.hnsw.efConstruction = 200
+            LIBRARY_INDEX.hnsw.efSearch = 64
+
+        # 旧版本的块作废
+        if known:
+            for entry_id in known['entry_ids']:
+                LIBRARY_ENTRIES[entry_id]['valid'] = False
+
+        base = LIBRARY_INDEX.ntotal
+        LIBRARY_INDEX.add(embeddings)
+        entry_ids = []
+        for i, e in enumerate(entries):
+            LIBRARY_ENTRIES.append({
+                'vtt_file': vtt_file,
+                'start': e['start'],
+                'end': e['end'],
+                'text': e['text'],
+                'valid': True
+            })
+            entry_ids.append(base + i)
+        LIBRARY_MANIFEST[vtt_file] = {'content_hash': content_hash, 'entry_ids': entry_ids}
+        if save:
+            _save_library_index()
+        return True
+
+
+def refresh_library_index():
+    """扫描 cache/subtitles，增量更新库级索引。返回统计信息。"""
+    added = 0
+    vtt_files = []
+    if os.path.isdir(SUBTITLE_LIBRARY_DIR):
+        for name in os.listdir(SUBTITLE_LIBRARY_DIR):
+            if name.lower().endswith('.vtt'):
+                vtt_files.append(os.path.join(SUBTITLE_LIBRARY_DIR, name))
+
+    for vtt_file in vtt_files:
+        try:
+            if add_file_to_library_index(vtt_file, save=False):
+                added += 1
+        except Exception as e:
+            print(f"库级索引: 处理 {vtt_file} 失败: {e}")
+
+    # 已删除的文件：块作废
+    removed = 0
+    with library_index_lock:
+        _load_library_index()
+        existing = set(os.path.abspath(p) for p in vtt_files)
+        for known_file in list(LIBRARY_MANIFEST.keys()):
+            if known_file not in existing and not os.path.exists(known_file):
+                for entry_id in LIBRARY_MANIFEST[known_file]['entry_ids']:
+                    LIBRARY_ENTRIES[entry_id]['valid'] = False
+                del LIBRARY_MANIFEST[known_file]
+                removed += 1
+        if added or removed:
+            _save_library_index()
+
+    total_valid = sum(1 for e in LIBRARY_ENTRIES if e['valid'])
+    return {
+        'files_indexed': len(LIBRARY_MANIFEST),
+        'files_added_or_updated': added,
+        'files_removed': removed,
+        'chunks': total_valid
+    }
+
+
+def search_library_index(query, top_k=20, min_score=0.5):
+    """在库级 HNSW 索引中执行跨文件搜索。"""
+    if not ensure_semantic_model():
+        raise RuntimeError("语义模型加载失败")
+    with library_index_lock:
+        _load_library_index()
+        if LIBRARY_INDEX is None or LIBRARY_INDEX.ntotal == 0:
+            return None  # 索引尚未构建
+
+        q_emb = MODEL.encode([query], normalize_embeddings=True)
+        # 多召回一些以补偿被过滤的 invalid 块
+        k = min(top_k * 3, LIBRARY_INDEX.ntotal)
+        scores, idxs = LIBRARY_INDEX.search(np.asarray(q_emb, dtype=np.float32), k)
+
+        results = []
+        for score, idx in zip(scores[0], idxs[0]):
+            if idx == -1 or score < min_score:
+                continue
+            entry = LIBRARY_ENTRIES[idx]
+            if not entry['valid']:
+                continue
+            results.append({
+                'vtt_file': os.path.basename(entry['vtt_file']),
+                'start': entry['start'],
+                'text': entry['text'],
+                'score': float(score)
+            })
+            if len(results) >= top_k:
+                break
+        return results
+
+
 # --- API 端点 ---
 @app.route('/search', methods=['GET'])
 def search_vtt():
@@ -218,6 +689,9 @@ def search_vtt():
 
     vtt_file_decoded = unquote(vtt_file)
 
+    if not ensure_semantic_model():
+        return jsonify({"error": "语义搜索模型加载失败"}), 503
+
     try:
         index, entries = get_or_build_index(vtt_file_decoded, chunk_params, force_rebuild)
         
@@ -239,6 +713,68 @@ def search_vtt():
         return jsonify({"error": "服务器内部错误"}), 500
 
 
+@app.route('/search_library', methods=['GET'])
+def search_library():
+    """
+    跨整个字幕库的语义搜索（ANN / HNSW）。
+    参数:
+    - query: 要搜索的文本。
+    - top_k (可选): 返回结果数量，默认为 20。
+    - min_score (可选): 最小相似度得分，默认为 0.5。
+    """
+    query = request.args.get('query')
+    if not query:
+        return jsonify({"error": "缺少 'query' 参数"}), 400
+
+    top_k = int(request.args.get('top_k', 20))
+    min_score = float(request.args.get('min_score', 0.5))
+
+    try:
+        results = search_library_index(query, top_k=top_k, min_score=min_score)
+        if results is None:
+            return jsonify({
+                "error": "库级索引尚未构建，请先调用 /api/library_index/refresh"
+            }), 409
+        return jsonify(results)
+    except RuntimeError as e:
+        return jsonify({"error": str(e)}), 503
+    except Exception as e:
+        print(f"库级搜索时发生错误: {e}")
+        return jsonify({"error": "服务器内部错误"}), 500
+
+
+@app.route('/api/library_index/refresh', methods=['POST'])
+def refresh_library():
+    """扫描 cache/subtitles 并增量更新库级索引（只编码新增/变化的文件）。"""
+    try:
+        stats = refresh_library_index()
+        return jsonify({"message": "库级索引已更新", **stats})
+    except Exception as e:
+        print(f"刷新库级索引时发生错误: {e}")
+        return jsonify({"error": f"刷新失败: {str(e)}"}), 500
+
+
+def _library_index_add_async(vtt_file):
+    """在后台线程中把新产出的 VTT 增量加入库级索引，不阻塞请求返回。"""
+    def run():
+        try:
+            if add_file_to_library_index(vtt_file):
+                print(f"库级索引: 已增量加入 {os.path.basename(vtt_file)}")
+        except Exception as e:
+            print(f"库级索引: 增量加入 {vtt_file} 失败: {e}")
+    threading.Thread(target=run, daemon=True).start()
+
+
+@app.route('/api/readiness', methods=['GET'])
+def readiness():
+    """各组件的就绪状态。HTTP 服务绑定即返回，UI 不必等模型加载完。"""
+    return jsonify({
+        'interactive': True,
+        'components': dict(COMPONENT_STATUS),
+        'all_ready': all(s == 'ready' for s in COMPONENT_STATUS.values())
+    })
+
+
 # --- 测试端点 ---
 @app.route('/api/test', methods=['GET', 'POST'])
 def test_endpoint():
@@ -308,7 +844,7 @@ def process_subtitle_task():
         print(f"[Flask Backend] 错误: {error_msg}")
         return jsonify({"error": error_msg}), 404
 
-    if CORRECTOR is None or not CORRECTOR.model:
+    if not ensure_corrector_model() or not CORRECTOR.model:
         return jsonify({"error": "模型未成功加载，无法处理请求"}), 503
 
     # 准备输出文件路径
@@ -412,6 +948,8 @@ def process_subtitle_task():
                 yield f"data: {json.dumps({'type': 'cancelled', 'task': task, 'vtt_file': vtt_file_relative, 'message': '任务已取消'}, ensure_ascii=False)}\n\n"
             elif processing_success[0]:
                 print(f"[Flask Backend] 文件{task}成功: {output_file}")
+                # 处理结果增量加入库级语义索引
+                _library_index_add_async(output_file)
                 yield f"data: {json.dumps({'type': 'complete', 'task': task, 'processed_file': output_file, 'vtt_file': vtt_file_relative}, ensure_ascii=False)}\n\n"
             else:
                 print(f"[Flask Backend] 文件{task}失败")
@@ -470,7 +1008,7 @@ def translate_vtt():
     if not os.path.exists(vtt_file_decoded):
         return jsonify({"error": f"文件不存在: {vtt_file_decoded}"}), 404
 
-    if CORRECTOR is None or not CORRECTOR.model:
+    if not ensure_corrector_model() or not CORRECTOR.model:
         return jsonify({"error": "翻译模块未成功加载，无法处理请求"}), 503
 
     try:
@@ -524,7 +1062,7 @@ def correct_vtt_only():
     if not os.path.exists(vtt_file_decoded):
         return jsonify({"error": f"文件不存在: {vtt_file_decoded}"}), 404
 
-    if CORRECTOR is None or not CORRECTOR.model:
+    if not ensure_corrector_model() or not CORRECTOR.model:
         return jsonify({"error": "纠错模块未成功加载，无法处理请求"}), 503
 
     try:
@@ -846,7 +1384,7 @@ def handle_chat():
     history = data.get('history', []) # 获取历史记录
     context = data.get('context', None) # 新增：获取视频上下文
 
-    if CORRECTOR is None or not CORRECTOR.model:
+    if not ensure_corrector_model() or not CORRECTOR.model:
         return jsonify({"error": "聊天功能不可用，模型未加载"}), 503
 
     try:
@@ -879,7 +1417,7 @@ def generate_glossary():
     if not os.path.exists(vtt_file_decoded):
         return jsonify({"error": f"文件不存在: {vtt_file_decoded}"}), 404
 
-    if CORRECTOR is None or not CORRECTOR.model:
+    if not ensure_corrector_model() or not CORRECTOR.model:
         return jsonify({"error": "模型未成功加载，无法处理请求"}), 503
 
     if not CORRECTOR.online_mode:
@@ -890,9 +1428,10 @@ def generate_glossary():
         
         # 初始化生成器
         glossary_generator = GlossaryGenerator(CORRECTOR)
-        
+
         # 执行生成 (新方法不再需要 output_file 参数)
-        success = glossary_generator.generate_from_vtt(vtt_file_decoded)
+        # 可选 series 参数启用按系列的增量术语表（新集数只做增量 Map）
+        success = glossary_generator.generate_from_vtt(vtt_file_decoded, series=data.get('series'))
 
         if success:
             # 构造正确的输出文件路径用于响应
@@ -965,6 +1504,32 @@ def cancel_subtitle_task():
             return jsonify({"success": False, "message": "任务未找到或已完成"}), 404
 
 
+@app.route('/api/preprocess_audio', methods=['POST'])
+def preprocess_audio():
+    """为流水线转录预先做音频预处理（响度分析/增益导出）。
+
+    /api/transcribe-directory 在 GPU 转录第 N 个文件时调用此端点预处理
+    第 N+1 个文件，随后把结果经 preprocessedAudioPath 传回转录请求，
+    让 CPU 上的音频处理与 GPU 推理相互重叠。
+    """
+    data = request.get_json()
+    if not data or not data.get('videoPath'):
+        return jsonify({'success': False, 'message': 'Missing videoPath'}), 400
+
+    video_path = data['videoPath']
+    output_dir = data.get('outputDir', './cache/subtitles/')
+
+    if not os.path.exists(video_path):
+        return jsonify({'success': False, 'message': f'File not found: {video_path}'}), 404
+
+    try:
+        processed_path = generate_subtitle.preprocess_audio_for_vad(video_path, output_dir)
+        return jsonify({'success': True, 'processed_audio_path': processed_path})
+    except Exception as e:
+        print(f"音频预处理失败: {e}")
+        return jsonify({'success': False, 'message': str(e)}), 500
+
+
 @app.route('/api/transcribe_video', methods=['POST'])
 def transcribe_video():
     """
@@ -1015,7 +1580,13 @@ def transcribe_video():
 
     if WHISPER_MODEL is None:
         return jsonify({'success': False, 'message': 'Failed to load Whisper model'}), 500
-        
+
+    # 标记转录进行中（空闲卸载看门狗据此避开活跃任务）
+    global WHISPER_ACTIVE_JOBS
+    with whisper_state_lock:
+        WHISPER_ACTIVE_JOBS += 1
+        _touch_whisper()
+
     try:
         # 获取配置中的默认值
         defaults = {}
@@ -1058,11 +1629,15 @@ def transcribe_video():
             merge_threshold=merge_threshold,
             dense_subtitles=dense_subtitles,
             max_chars_per_line=max_chars_per_line,
-            loaded_model=WHISPER_MODEL
+            loaded_model=WHISPER_MODEL,
+            preprocessed_audio_path=data.get('preprocessedAudioPath')
         )
         
+        # 新产出的字幕增量加入库级语义索引
+        _library_index_add_async(vtt_path)
+
         return jsonify({
-            'success': True, 
+            'success': True,
             'vtt_file': vtt_path.replace('\\', '/')
         })
         
@@ -1071,12 +1646,18 @@ def transcribe_video():
         import traceback
         traceback.print_exc()
         return jsonify({'success': False, 'message': str(e)}), 500
+    finally:
+        # 任务结束：释放活跃标记并刷新空闲计时
+        with whisper_state_lock:
+            WHISPER_ACTIVE_JOBS -= 1
+            _touch_whisper()
 
 
 if __name__ == '__main__':
-    load_global_model()
-    load_corrector_model()
-    load_transcription_model()
+    # 启动即绑定 HTTP（UI 2 秒内可交互），模型在后台线程并行预热；
+    # 各组件进度经 /api/readiness 汇报，未就绪前相关端点按需同步加载。
+    for preload in (ensure_semantic_model, ensure_corrector_model, ensure_transcription_model):
+        threading.Thread(target=preload, daemon=True).start()
     # 使用 waitress 或 gunicorn 在生产环境中运行
     # 例如: waitress-serve --host 127.0.0.1 --port 5000 semantic-search-app:app
     # 这里为了简单起见，直接用 Flask 的开发服务器
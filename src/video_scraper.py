@@ -90,6 +90,8 @@ import urllib3
 import urllib.parse
 import copy
 import concurrent.futures
+import threading
+import time
 
 # 新增 cloudscraper 导入
 try:
@@ -143,6 +145,100 @@ HEADERS = {
     'Cache-Control': 'max-age=0'
 }
 
+# ==============================================================================
+# 抓取引擎：按域名复用的 keep-alive 会话 + 每域名限速 + 重试预算
+# ==============================================================================
+
+class FetchEngine:
+    """所有刮削源共享的网络层。
+
+    - 每个域名一个持久 requests.Session（连接池 keep-alive；javbus/fanza/fc2
+      的年龄认证等会话预热只做一次，而不是每个标题重来一遍）
+    - 每个域名独立限速，批量并行刮削多个标题也不会轰炸单一来源
+    - 临时性失败（网络异常、429/5xx）在每次请求的重试预算内指数退避重试
+    """
+
+    TRANSIENT_STATUS = (429, 502, 503, 504)
+
+    def __init__(self, min_interval=1.0, retry_budget=2):
+        self.min_interval = min_interval
+        self.retry_budget = retry_budget
+        self._lock = threading.Lock()
+        self._domains = {}  # 域名 -> {'session', 'lock', 'next_allowed', 'configured'}
+
+    def _domain_state(self, domain):
+        with self._lock:
+            state = self._domains.get(domain)
+            if state is None:
+                session = requests.Session()
+                session.headers.update(HEADERS)
+                state = {
+                    'session': session,
+                    'lock': threading.Lock(),
+                    'next_allowed': 0.0,
+                    'configured': False
+                }
+                self._domains[domain] = state
+            return state
+
+    @staticmethod
+    def _domain_of(url):
+        return urllib.parse.urlsplit(url).netloc or url
+
+    def session_for(self, url, setup=None):
+        """获取 url 所属域名的持久会话；setup(session) 只在首次使用时执行一次。"""
+        state = self._domain_state(self._domain_of(url))
+        if setup is not None and not state['configured']:
+            with state['lock']:
+                if not state['configured']:
+                    setup(state['session'])
+                    state['configured'] = True
+        return state['session']
+
+    def throttle(self, url):
+        """阻塞直到该域名允许下一次请求（线程安全）。"""
+        state = self._domain_state(self._domain_of(url))
+        while True:
+            with state['lock']:
+                now = time.monotonic()
+                if now >= state['next_allowed']:
+                    state['next_allowed'] = now + self.min_interval
+                    return
+                wait = state['next_allowed'] - now
+            time.sleep(wait)
+
+    def request(self, method, url, session=None, **kwargs):
+        sess = session if session is not None else self.session_for(url)
+        last_exc = None
+        for attempt in range(self.retry_budget + 1):
+            self.throttle(url)
+            try:
+                response = sess.request(method, url, **kwargs)
+                if response.status_code in self.TRANSIENT_STATUS and attempt < self.retry_budget:
+                    print(f"  [重试] {self._domain_of(url)} 返回 {response.status_code}，第 {attempt + 1} 次退避重试...", file=sys.stderr)
+                    time.sleep(self.min_interval * (2 ** attempt))
+                    continue
+                return response
+            except requests.exceptions.RequestException as e:
+                last_exc = e
+                if attempt < self.retry_budget:
+                    print(f"  [重试] {self._domain_of(url)} 请求失败 ({e.__class__.__name__})，第 {attempt + 1} 次退避重试...", file=sys.stderr)
+                    time.sleep(self.min_interval * (2 ** attempt))
+        raise last_exc
+
+    def get(self, url, **kwargs):
+        return self.request('GET', url, **kwargs)
+
+    def post(self, url, **kwargs):
+        return self.request('POST', url, **kwargs)
+
+
+_scraper_config = config.get('scraper', {})
+FETCH = FetchEngine(
+    min_interval=_scraper_config.get('domain_min_interval_seconds', 1.0),
+    retry_budget=_scraper_config.get('domain_retry_budget', 2)
+)
+
 # 初始化 TMDb API
 tmdb = TMDb()
 tmdb.api_key = TMDB_API_KEY
@@ -354,6 +450,13 @@ class CacheManager:
                 )
                 print(f"  [缓存] 已为 '{filename}' 创建新的数据库记录。", file=sys.stderr)
 
+        # 增量更新搜索倒排索引（search_videos.py 维护；失败不影响缓存写入）
+        try:
+            import search_videos
+            search_videos.update_index_for_entry(self.conn, filename, data)
+        except Exception as e:
+            print(f"  [索引] 更新搜索索引失败: {e}", file=sys.stderr)
+
     def _find_poster_url(self, data):
         """在刮削结果中找到海报URL"""
         # 优先使用 jav_results 中的最佳匹配
@@ -400,7 +503,7 @@ class CacheManager:
                 pass # URL无效则不设置Referer
 
             print(f"  [缓存] 正在下载封面: {url}", file=sys.stderr)
-            response = requests.get(url, headers=download_headers, timeout=20, stream=True, verify=False)
+            response = FETCH.get(url, headers=download_headers, timeout=20, stream=True, verify=False)
             response.raise_for_status()
             
             with open(save_path, 'wb') as f:
@@ -840,11 +943,8 @@ class Scraper:
             
         search_url = f"{JAVBUS_BASE_URL}/{jav_id.upper()}"
         
-        try:
-            session = requests.Session()
-            session.headers.update(HEADERS)
-            
-            # 设置更全面的cookies以尝试绕过年龄验证
+        def _setup_javbus(session):
+            # 会话预热只在进程内做一次：设置年龄验证 cookies 并访问主页确认状态
             cookies = {
                 'existmag': 'mag',
                 'age_check': '1',
@@ -852,11 +952,11 @@ class Scraper:
                 'tips': '1'
             }
             session.cookies.update(cookies)
-            
+
             # 先访问主页
             homepage_response = session.get(JAVBUS_BASE_URL, timeout=10)
             homepage_response.raise_for_status()
-            
+
             # 检查是否有重定向到年龄认证页面
             if '/age_confirm/' in homepage_response.url or '年齡確認' in homepage_response.text:
                 # 如果被重定向到年龄认证页面，尝试模拟点击确认
@@ -870,14 +970,17 @@ class Scraper:
                 age_headers['Referer'] = homepage_response.url
                 age_headers['Content-Type'] = 'application/x-www-form-urlencoded'
                 session.post(age_confirm_url, data=age_confirm_data, headers=age_headers, timeout=10)
-            
-            # 再次访问主页确保状态正确
-            session.get(JAVBUS_BASE_URL, timeout=10)
-            
-            # 最后访问目标页面，添加更完整的Referer头部
+
+                # 再次访问主页确保状态正确
+                session.get(JAVBUS_BASE_URL, timeout=10)
+
+        try:
+            session = FETCH.session_for(JAVBUS_BASE_URL, setup=_setup_javbus)
+
+            # 访问目标页面，添加更完整的Referer头部
             headers_with_referer = HEADERS.copy()
             headers_with_referer['Referer'] = JAVBUS_BASE_URL + '/'
-            response = session.get(search_url, headers=headers_with_referer, timeout=15)  # 增加超时时间
+            response = FETCH.get(search_url, session=session, headers=headers_with_referer, timeout=15)
             response.raise_for_status()
 
             soup = BeautifulSoup(response.text, 'html.parser')
@@ -964,13 +1067,15 @@ class Scraper:
             'age_check_done': '1'
         }
 
-        try:
-            session = requests.Session()
+        def _setup_fanza(session):
             session.headers.update(headers)
             session.cookies.update(cookies)
 
+        try:
+            session = FETCH.session_for(search_url, setup=_setup_fanza)
+
             # --- 第一步：搜索影片，获取详情页链接 ---
-            search_response = session.get(search_url, timeout=15)
+            search_response = FETCH.get(search_url, session=session, timeout=15)
             search_response.raise_for_status()
 
             if '/-/detail/=/cid=' in search_response.url:
@@ -988,9 +1093,9 @@ class Scraper:
                     return {"error": "无法从第一个搜索结果中找到链接。"}
                 
                 detail_url = link_tag['href']
-                
+
                 # --- 第二步：访问详情页 ---
-                response = session.get(detail_url, timeout=15)
+                response = FETCH.get(detail_url, session=session, timeout=15)
                 response.raise_for_status()
 
             soup = BeautifulSoup(response.text, 'html.parser')
@@ -1086,7 +1191,7 @@ class Scraper:
         payload = {'sn': jav_id}
 
         try:
-            response = requests.post(search_post_url, headers=headers, data=payload, timeout=15)
+            response = FETCH.post(search_post_url, headers=headers, data=payload, timeout=15)
             response.raise_for_status()
         except requests.exceptions.RequestException as e:
             return {"error": f"访问 Jav321 时网络错误: {e}"}
@@ -1325,33 +1430,28 @@ class Scraper:
         # 目标 URL
         url = f"https://ads.contents.fc2.com/article/{numeric_id}/"
 
-        # 使用 session 管理 cookies 和 headers
-        session = requests.Session()
-        
         # 构造一个更真实的 Referer，模拟从 Bing 搜索结果页点击过来
         bing_search_url = f"https://www.bing.com/search?q=fc2-{numeric_id}"
-        
-        # 更新 headers
-        fc2_headers = HEADERS.copy()
-        fc2_headers.update({
-            'Referer': bing_search_url,
-            'Accept-Language': 'zh-CN,zh;q=0.9,en;q=0.8',
-        })
-        session.headers.update(fc2_headers)
-
-        # 设置必要的 cookies
-        session.cookies.set('age_check_done', '1', domain='.fc2.com')
-        session.cookies.set('contents_func_mode', 'buy', domain='.fc2.com')
-        session.cookies.set('contents_mode', 'digital', domain='.fc2.com')
+
+        def _setup_fc2(session):
+            # 更新 headers
+            fc2_headers = HEADERS.copy()
+            fc2_headers.update({
+                'Accept-Language': 'zh-CN,zh;q=0.9,en;q=0.8',
+            })
+            session.headers.update(fc2_headers)
+
+            # 设置必要的 cookies
+            session.cookies.set('age_check_done', '1', domain='.fc2.com')
+            session.cookies.set('contents_func_mode', 'buy', domain='.fc2.com')
+            session.cookies.set('contents_mode', 'digital', domain='.fc2.com')
+
+        # 使用按域名复用的持久会话管理 cookies 和 headers
+        session = FETCH.session_for(url, setup=_setup_fc2)
 
         try:
-            # 模拟用户行为：先访问一下主页，让网站设置一些初始 cookies
-            # 这有助于模拟一个更真实的用户会话
-            #print("  -> 正在访问 FC2 主页以初始化会话...", file=sys.stderr)
-            #session.get("https://adult.contents.fc2.com/", timeout=15, verify=False)
-            
             print(f"  -> 正在请求影片页面: {url}", file=sys.stderr)
-            response = session.get(url, timeout=15, verify=False)
+            response = FETCH.get(url, session=session, headers={'Referer': bing_search_url}, timeout=15, verify=False)
             response.raise_for_status()
             response.encoding = response.apparent_encoding
 
@@ -1496,7 +1596,7 @@ class Scraper:
         headers = {"User-Agent": "BangumiScraper/1.0 (compatible;)"}
 
         try:
-            search_response = requests.get(search_url, headers=headers)
+            search_response = FETCH.get(search_url, headers=headers, timeout=15)
             search_response.raise_for_status()
             search_response.encoding = 'utf-8'
 
@@ -1521,7 +1621,7 @@ class Scraper:
             subject_id = subject_id_match.group(1)
 
             detail_url = f"https://api.bgm.tv/v0/subjects/{subject_id}"
-            detail_response = requests.get(detail_url, headers=headers)
+            detail_response = FETCH.get(detail_url, headers=headers, timeout=15)
             detail_response.raise_for_status()
             detail_api = detail_response.json()
             
@@ -1540,7 +1640,7 @@ class Scraper:
             }
 
             subject_page_url = f"https://bangumi.tv/subject/{subject_id}"
-            page_response = requests.get(subject_page_url, headers=headers)
+            page_response = FETCH.get(subject_page_url, headers=headers, timeout=15)
             page_response.raise_for_status()
             page_response.encoding = 'utf-8'
             page_soup = BeautifulSoup(page_response.text, 'html.parser')
@@ -1625,7 +1725,7 @@ class Scraper:
 
         try:
             # 1. 访问搜索页面
-            search_response = requests.get(search_url, headers=headers, cookies=cookies, timeout=15)
+            search_response = FETCH.get(search_url, headers=headers, cookies=cookies, timeout=15)
             search_response.raise_for_status()
             search_response.encoding = 'EUC-JP'  # Getchu 使用 EUC-JP 编码
 
@@ -1643,7 +1743,7 @@ class Scraper:
             detail_url = urllib.parse.urljoin(search_response.url, link['href'])
 
             # 3. 访问详情页面
-            detail_response = requests.get(detail_url, headers=headers, cookies=cookies, timeout=15)
+            detail_response = FETCH.get(detail_url, headers=headers, cookies=cookies, timeout=15)
             detail_response.raise_for_status()
             detail_response.encoding = 'EUC-JP'
             detail_soup = BeautifulSoup(detail_response.text, 'html.parser')
@@ -1793,6 +1893,7 @@ class Scraper:
         search_url = f"https://hanime1.me/search?query={urllib.parse.quote_plus(query)}&type=&genre=%E8%A3%8F%E7%95%AA"
 
         try:
+            FETCH.throttle(search_url)
             search_response = scraper.get(search_url, timeout=15)
             search_response.raise_for_status()
 
@@ -1804,6 +1905,7 @@ class Scraper:
             
             detail_url = urllib.parse.urljoin(search_response.url, link_tag['href'])
 
+            FETCH.throttle(detail_url)
             detail_response = scraper.get(detail_url, timeout=15)
             detail_response.raise_for_status()
             detail_soup = BeautifulSoup(detail_response.text, 'html.parser')
@@ -1862,6 +1964,57 @@ class Scraper:
 # ==============================================================================
 # 主程序入口
 # ==============================================================================
+def run_batch_from_stdin(video_type, force_online, skip_existing, enabled_scrapers, workers):
+    """批量模式：从 stdin 逐行读取文件路径，线程池并行刮削，按完成顺序输出 NDJSON 进度。
+
+    输出行格式: {"path": ..., "status": "skipped"|"ok"|"error", "data": {...}}
+
+    一个标题的解析与其他标题的网络等待在线程池里自然重叠（流水线），
+    对单一来源的并发压力由 FetchEngine 的每域名限速兜底。
+    """
+    file_paths = [line.strip() for line in sys.stdin if line.strip()]
+    print(f"批量刮削 {len(file_paths)} 个文件 (workers={workers})", file=sys.stderr)
+
+    output_lock = threading.Lock()
+    tls = threading.local()
+
+    def get_scraper():
+        # sqlite 连接不可跨线程共享：每个工作线程一个 CacheManager
+        if not hasattr(tls, 'scraper'):
+            tls.scraper = Scraper(CacheManager(DB_PATH, IMAGE_DIR))
+        return tls.scraper
+
+    def emit(obj):
+        with output_lock:
+            print(json.dumps(obj, ensure_ascii=False, cls=CustomEncoder), flush=True)
+
+    def process(file_path):
+        scraper = get_scraper()
+        filename = os.path.basename(file_path)
+        try:
+            if skip_existing and not force_online:
+                cached_data, _ = scraper.cache.get_info(filename)
+                if cached_data:
+                    emit({"path": file_path, "status": "skipped"})
+                    return
+            data = scraper.scrape(
+                file_path,
+                video_type=video_type,
+                force_online=force_online,
+                enabled_scrapers=enabled_scrapers
+            )
+            translated = translate_keys(data, KEY_TRANSLATION_MAP)
+            status = "error" if isinstance(data, dict) and data.get('error') else "ok"
+            emit({"path": file_path, "status": status, "data": translated})
+        except Exception as e:
+            emit({"path": file_path, "status": "error", "data": {"error": str(e)}})
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=workers) as executor:
+        list(executor.map(process, file_paths))
+
+    print("批量刮削完成", file=sys.stderr)
+
+
 def main():
     """主函数"""
     if not TMDB_API_KEY or TMDB_API_KEY == 'YOUR_TMDB_API_KEY':
@@ -1899,7 +2052,23 @@ def main():
     if '--skip-existing' in args:
         skip_existing = True
         args.remove('--skip-existing')
-    
+
+    batch_stdin = False
+    if '--batch-stdin' in args:
+        batch_stdin = True
+        args.remove('--batch-stdin')
+
+    batch_workers = _scraper_config.get('batch_workers', 4)
+    if '--workers' in args:
+        try:
+            w_index = args.index('--workers')
+            batch_workers = int(args[w_index + 1])
+            args.pop(w_index)
+            args.pop(w_index)
+        except (IndexError, ValueError):
+            print("错误: --workers 参数后面需要一个整数。", file=sys.stderr)
+            sys.exit(1)
+
     if '--delete' in args:
         delete_record = True
         args.remove('--delete')
@@ -1943,6 +2112,14 @@ def main():
         print("错误: 使用 --force-search [title] 时必须同时指定 video_type。", file=sys.stderr)
         sys.exit(1)
 
+    # --- 批量模式：文件列表来自 stdin，没有位置参数形式的刮削目标 ---
+    if batch_stdin:
+        # 批量模式下第一个位置参数（如果有）是视频类型
+        if not video_type and scrape_target and scrape_target.lower() in valid_types:
+            video_type = scrape_target.lower()
+        run_batch_from_stdin(video_type, force_online, skip_existing, enabled_scrapers, batch_workers)
+        sys.exit(0)
+
     # --- 如果没有通过参数提供输入，则提示用户输入 ---
     if not scrape_target:
         scrape_target = input("请输入视频文件的完整路径、文件名或番号: ").strip()